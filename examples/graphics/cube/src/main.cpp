@@ -1,7 +1,13 @@
-
 #include <glint/glint.h>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <vector>
+
+// stress scene: a GRID x GRID x GRID block of spinning cubes, drawn with one instanced call
+#define GRID 16
+#define SPACING 1.5f
+
+static std::vector<mat4> g_models;
 
 extern "C" void glattach(void* ctx) {
 
@@ -13,7 +19,13 @@ extern "C" void glattach(void* ctx) {
 
 extern "C" void app_setup() {
 
+    g_models.resize(GRID * GRID * GRID);
 
+    // let the scene drop resolution rather than frames when the grid gets too heavy
+    GlDynamicResolution resolution;
+    resolution.minScale = 0.5f;
+    resolution.targetFps = 60.0f;
+    glDynamicResolutionEnable(resolution);
 
 }
 
@@ -24,34 +36,53 @@ extern "C" int app_present() {
 }
 
 extern "C" int app_cycle() {
-    glEnable(GL_DEPTH_TEST);  
+    glEnable(GL_DEPTH_TEST);
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
-    glCameraSetPerspective(45.0f, 800.0f/480.0f, 0.1f, 100.0f);
-    glCameraSetView(vec3(1,1,1), vec3(0,0,0), vec3(0,1,0));
+    float time = (float)glGetTime();
 
-    mat4 model = mat4::identity();
-    model *= mat4::rotationY((float)glGetTime());
-    model *= mat4::rotationX((float)glGetTime() * 0.5f);
+    glCameraSetPerspective(45.0f, 800.0f/480.0f, 0.1f, 100.0f);
+    glCameraSetView(vec3(sinf(time * 0.2f) * 40.0f, 20.0f, cosf(time * 0.2f) * 40.0f), vec3(0,0,0), vec3(0,1,0));
+
+    float offset = (GRID - 1) * SPACING * 0.5f;
+    int index = 0;
+    for (int x = 0; x < GRID; x++) {
+        for (int y = 0; y < GRID; y++) {
+            for (int z = 0; z < GRID; z++) {
+                float phase = (x * 7 + y * 13 + z * 29) * 0.1f;
+
+                mat4 model = mat4::identity();
+                model *= mat4::rotationY(time + phase);
+                model *= mat4::rotationX(time * 0.5f + phase);
+
+                // place the cube; the matrices are column-major, so translation lives in m[12..14]
+                model.m[12] = x * SPACING - offset;
+                model.m[13] = y * SPACING - offset;
+                model.m[14] = z * SPACING - offset;
+
+                g_models[index++] = model;
+            }
+        }
+    }
 
-    //glDebugTextFmt("Hello, Glint! Time: %.2f", glGetTime());
-    // delta time
-    //glDebugTextFmt("Delta Time: %.4f", glGetDeltaTime());
+    glCubeDrawInstanced(g_models.data(), index, 0); // shader 0 is the built-in instanced shader
 
-    glCubeDraw(model, 0); // Using shader 0 for now, will need to set up a proper shader later
+    glDebugTextFmt("Cubes: %d", index);
+    glDebugTextFmt("Delta Time: %.4f", glGetDeltaTime());
+    glDebugTextFmt("Render Scale: %.2f", glGetRenderScale());
 
     if (hidIsButtonPressed(GLFW_KEY_ESCAPE)) {
         return 2; // Pause to home screen
     }
-    
+
     /*
     if (game_over) {
         return 1; // Exit application
     }
     */
-    
+
 
     return 0; // Continue running
 }
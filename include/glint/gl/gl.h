@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstddef>
+
 #include "glint/types/math.h"
+#include "glint/types/graphics.h"
 
-void* glSetup();
+void* glSetup(bool headless = false);
 void glShutdown();
 
 bool glRunning();
@@ -12,10 +15,50 @@ double glGetTime();
 double glGetDeltaTime();
 
 int glGenerateShader(const char* vertexSrc, const char* fragmentSrc);
+
+// shader uniforms: slots are resolved once, setters skip values that did not change
+int glShaderGetUniform(int shader, const char* name);
+void glShaderUse(int shader);
+void glShaderSetInt(int shader, int slot, int value);
+void glShaderSetFloat(int shader, int slot, float value);
+void glShaderSetVec2(int shader, int slot, vec2 value);
+void glShaderSetVec3(int shader, int slot, vec3 value);
+void glShaderSetVec4(int shader, int slot, vec4 value);
+void glShaderSetMat4(int shader, int slot, const mat4& value);
 int glGenerateTexture(int width, int height, const unsigned char* data, int desiredChannels);
 int glGenerateTexture(const unsigned char* data, int dataSize, int desiredChannels=3);
 int glGenerateTexture(const char* filePath, int desiredChannels=3);
 
+// texture cache: file and encoded-memory loads are shared by path or content and refcounted
+struct GlTextureStats {
+    size_t residentBytes = 0;   // GPU memory held by tracked textures, in use or not
+    size_t budget = 0;          // limit for keeping released textures resident
+    int textureCount = 0;
+    int unusedCount = 0;        // released but still resident
+    int hits = 0;
+    int misses = 0;
+    int evictions = 0;
+};
+
+// async loads return a usable handle at once; it shows a transparent placeholder until glPresent uploads the image
+int glGenerateTextureAsync(const char* filePath, int desiredChannels=3);
+bool glTextureIsReady(int texture);
+
+// texture atlases packed by glt_execcreate: resolves a resource path to a page and UV rect
+struct GlAtlasRegion {
+    int texture = 0;            // a reference owned by the caller, release it with glReleaseTexture
+    float u0 = 0.0f, v0 = 0.0f, u1 = 1.0f, v1 = 1.0f;
+    int width = 0, height = 0;  // source image size in pixels; 0 for an unpacked image until its upload lands
+};
+
+bool glAtlasLookup(const char* path, GlAtlasRegion* region);
+
+void glReleaseTexture(int texture);
+void glTextureSetBudget(size_t bytes);
+bool glTextureGetSize(int texture, int* width, int* height);
+void glTextureTouch(int texture);   // after writing pixels into a texture yourself, so effects cached from it are redone
+GlTextureStats glGetTextureStats();
+
 void glDebugText(const char* text);
 void glDebugTextFmt(const char* format, ...);
 void glDebugTextFmt(unsigned long color, unsigned long bg, const char* format, ...);
@@ -24,8 +67,140 @@ void glDebugText(unsigned long color, unsigned long bg,const char* text);
 
 void* glGetContext();
 
+// headless mode (glSetup(true) or GLINT_HEADLESS=1): EGL context without a window, rendering offscreen
+bool glIsHeadless();
+
+// 2D canvas: the coordinate space of sprites, quads, debug text and ui2d, stretched over the viewport.
+// 800x480 by default whatever the panel size; offscreen passes set it to their target size and restore it
+void glCanvasSetSize(float width, float height);
+vec2 glCanvasGetSize();
+void glGetScreenSize(int* width, int* height);  // the panel in pixels, 800x480 unless GLINT_SCREEN_SIZE=WxH
+
+// frame readback: the current frame as screen-size RGBA8, top row first
+bool glReadFrame(unsigned char* rgba);
+bool glSaveFrame(const char* path);
+
+// GPU copy of the current frame into a texture, top row first; scale < 1 captures at reduced resolution.
+// pass the previous capture to reuse it, 0 (or a texture of another size) creates a new one
+int glCaptureFramebufferToTexture(int texture, float scale = 1.0f);
+
+// asynchronous capture: frames are read back through a ring of pixel buffers at glPresent and encoded
+// on the job pool, so capturing does not stall the frame. ".tga" paths are written as RLE targa, anything else as PNG
+struct GlCaptureStats {
+    int requested = 0;  // frames queued for capture
+    int written = 0;    // files written
+    int dropped = 0;    // frames skipped because every readback buffer or encoder slot was busy
+    int failed = 0;     // frames that could not be mapped or written
+    int pending = 0;    // frames read back or encoding, not yet on disk
+};
+
+bool glCaptureScreenshot(const char* path);                             // the next presented frame
+bool glCaptureStart(const char* pattern, int frames = 0, int interval = 1); // pattern like "captures/frame_%05d.tga"; frames 0 records until stopped
+void glCaptureStop();
+GlCaptureStats glGetCaptureStats(); // totals since startup
+
+// dynamic resolution: framebuffer 0 becomes an offscreen target whose size follows the measured frame time,
+// upscaled at glPresent. scales are relative to the screen size and move in steps of 0.05
+struct GlDynamicResolution {
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+    float targetFps = 60.0f;
+};
+
+bool glDynamicResolutionEnable(const GlDynamicResolution& settings = GlDynamicResolution());
+void glDynamicResolutionDisable();
+float glGetRenderScale();                       // 1 when dynamic resolution is off
+void glGetRenderSize(int* width, int* height);  // size of the area being rendered this frame
+
 void glQuadDraw(float x, float y, float width, float height, int shader);
+
+// sprite batching: quads are collected and drawn grouped by shader and texture
+struct GlSprite {
+    float x = 0.0f, y = 0.0f, width = 0.0f, height = 0.0f;
+    float u0 = 0.0f, v0 = 0.0f, u1 = 1.0f, v1 = 1.0f;
+    ColorRGB tint = {1.0f, 1.0f, 1.0f};
+    float alpha = 1.0f;
+    int texture = 0;    // 0 draws untextured (white), -1 keeps the currently bound texture
+    int shader = 0;     // 0 uses the built-in sprite shader
+};
+
+void glSpriteBatchDraw(const GlSprite& sprite);
+void glSpriteBatchFlush();
+
+// render target pool: color textures with a framebuffer, shared by size and format. borrow one for a pass and
+// release it when the draws sampling it have been issued; targets unused for 120 presents are freed
+struct GlRenderTarget {
+    int framebuffer = 0;
+    int texture = 0;
+    int width = 0;
+    int height = 0;
+};
+
+struct GlRenderTargetStats {
+    int targets = 0;        // pooled targets, in use or idle
+    int inUse = 0;
+    size_t bytes = 0;       // texture memory held by the pool
+    size_t peakBytes = 0;
+    int created = 0;        // acquires that had to allocate
+    int reused = 0;         // acquires served from the pool
+};
+
+GlRenderTarget glRenderTargetAcquire(int width, int height, unsigned int internalFormat = 0x8058); // GL_RGBA8
+void glRenderTargetRelease(const GlRenderTarget& target);
+void glRenderTargetTrim();  // free every idle target now
+GlRenderTargetStats glGetRenderTargetStats();
+
+// gl state cache: binds made through glint skip calls that would not change anything
+struct GlStateCounter {
+    int issued = 0;     // calls that reached GL
+    int skipped = 0;    // calls dropped because the state already matched
+};
+
+struct GlStateStats {
+    GlStateCounter program;
+    GlStateCounter vertexArray;
+    GlStateCounter texture;
+    GlStateCounter capability;
+    GlStateCounter blendFunc;
+    GlStateCounter framebuffer;
+    GlStateCounter viewport;
+    int issued = 0;
+    int skipped = 0;
+};
+
+GlStateStats glGetStateStats(); // counts for the last presented frame
+void glStateInvalidate();       // call after changing GL state directly
+
+// shader program cache: linked programs are kept under sys/shadercache/ and reloaded with glProgramBinary
+struct GlShaderCacheStats {
+    int hits = 0;           // programs loaded from a cached binary
+    int misses = 0;         // programs compiled from source
+    int rejected = 0;       // cached binaries the driver refused (they are recompiled and replaced)
+    double compileMs = 0;   // time spent compiling from source
+    double loadMs = 0;      // time spent loading cached binaries
+    double savedMs = 0;     // compile time the cache hits avoided
+};
+
+GlShaderCacheStats glGetShaderCacheStats(); // totals since startup
+void glTextureBind(int unit, int texture);
 void glCubeDraw(mat4 model, int shader);
+void glCubeDrawInstanced(const mat4* models, int count, int shader); // one draw call for all cubes
+
+// meshes: vertex/index buffers created once and drawn through the instanced path; loads are shared by path and refcounted
+struct GlMeshAttribute {
+    int location = 0;           // 0 position, 1 normal, 2 texcoord for the default shader; 3-9 are taken by instancing
+    int components = 3;
+    unsigned int type = 0x1406; // GL_FLOAT
+    bool normalized = false;
+    int offset = 0;             // bytes from the start of the vertex
+};
+
+int glMeshCreate(const GlMeshAttribute* attributes, int attributeCount, int stride, const void* vertices, int vertexCount, const void* indices, int indexCount, int indexSize);
+int glMeshLoad(const char* path);   // .gmesh, written by glt_execcreate
+void glMeshRelease(int mesh);
+void glMeshDraw(int mesh, mat4 model, int shader);
+void glMeshDrawInstanced(int mesh, const mat4* models, int count, int shader);
+bool glMeshGetBounds(int mesh, vec3* boundsMin, vec3* boundsMax);
 
 void glCameraSetOrtho(float left, float right, float bottom, float top);
 void glCameraSetPerspective(float fovY, float aspect, float nearZ, float farZ);
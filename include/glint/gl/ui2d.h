@@ -3,6 +3,15 @@
 #include "glint/types/graphics.h"
 
 struct UiFrame;
+struct UiFramePool;
+struct UiTree;
+
+// names a frame without keeping it alive: resolves to nullptr once the frame is destroyed, even if its memory
+// has been reused for a new frame
+struct UiFrameHandle {
+    unsigned int index = 0;
+    unsigned int generation = 0;    // never 0 for a live frame
+};
 
 struct UiLayoutSettings {
     enum Type {
@@ -39,10 +48,6 @@ struct UiEffectSettings {
     // blur
     bool blurEnabled = false;
     float blurRadius = 0.0f;
-    bool blurPassesSetup = false;
-    int blurFramebuffers[2];
-    int blurTextures[2];
-    int blurTextureWidth, blurTextureHeight;
 
 
     // drop shadow
@@ -65,11 +70,19 @@ private:
 
 };
 
+// where a frame ends up on the canvas once layout has placed it
+struct UiRect {
+    float x, y, width, height;
+
+    bool contains(float px, float py) const { return px >= x && py >= y && px < x + width && py < y + height; }
+};
+
 struct UiFrame {
     float x, y, width, height;
     float alpha = 1.0f;
     ColorRGB color = {1,1,1};
     int texture = -1;
+    float u0 = 0.0f, v0 = 0.0f, u1 = 1.0f, v1 = 1.0f; // sub-rectangle of texture, set by setImage for atlas images
 
     bool forceAlpha = false;
     bool visible = true;
@@ -83,6 +96,7 @@ struct UiFrame {
     std::vector<UiFrame*> children;
     UiFrame* parent = nullptr;
     void setParent(UiFrame& parent);
+    void setImage(const char* path);
 
     void setAsMainFrame();
     bool isSelected();
@@ -90,6 +104,8 @@ struct UiFrame {
     void select();
 
     void calculateAutoSize();
+    void updateLayout();
+    UiRect getResolvedRect() const { return {layoutX, layoutY, width, height}; }
 
 
     void draw_internal();
@@ -101,14 +117,30 @@ struct UiFrame {
     void revertLayout();
 
 private:
+    friend UiFramePool;
+    friend UiTree;
 
     UiLayoutSettings layoutSettings;
     UiEffectSettings effectSettings;
 
-    std::tuple<float,float> getLayoutPosition();
+    unsigned int poolSlot = ~0u;    // slot in the frame pool, ~0u for frames not made by ui2dAddFrame
+    int treeIndex = -1;             // position in the flattened main tree, when it is current
+    bool destroyed = false;         // destroyed while callbacks were running; released once they are done
 
     std::tuple<float,float> preLayout;
 
+    // layout cache, brought up to date by updateLayout. A container's children are placed again only when it is
+    // dirty, which a change to its position, size, settings, children or a child's size makes it
+    float layoutX = 0.0f, layoutY = 0.0f;      // resolved position on the canvas
+    bool layoutDirty = true;
+    float layoutSeen[4] = {};                   // x, y, width and height at the last update
+    UiLayoutSettings layoutSeenSettings = {};
+    size_t layoutSeenChildren = 0;
+    bool layoutSeenSelectable = false;
+
+    bool layoutCheck();
+    void layoutArrange();
+
     std::vector<UiFrame*> getAllFrames() {
         std::vector<UiFrame*> allFrames;
         allFrames.push_back(this);
@@ -127,4 +159,10 @@ void ui2dDraw();
 
 UiFrame& ui2dGetMainFrame();
 
-UiFrame& ui2dAddFrame(float x, float y, float width, float height);
\ No newline at end of file
+UiFrame& ui2dAddFrame(float x, float y, float width, float height);
+void ui2dDestroyFrame(UiFrame& frame);
+
+UiFrameHandle ui2dGetFrameHandle(const UiFrame& frame);
+UiFrame* ui2dGetFrame(UiFrameHandle handle);
+
+UiFrame* ui2dHitTest(float x, float y);
\ No newline at end of file
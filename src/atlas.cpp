@@ -0,0 +1,143 @@
+#include "glint/glint.h"
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "exec_internal.h"
+#include "gl_internal.h"
+
+struct AtlasPage {
+    int width;
+    int height;
+    int texture;    // loaded on first lookup that lands on the page; the table keeps that reference for good
+};
+
+struct AtlasRect {
+    int page;
+    int x, y, width, height;
+};
+
+struct AtlasTable {
+    std::vector<AtlasPage> pages;
+    std::unordered_map<std::string, AtlasRect> rects;
+};
+
+// rect tables by mount point ("S:/"), read the first time a path on that mount is looked up
+static std::unordered_map<std::string, AtlasTable> g_atlases;
+
+static uint16_t atlasRead16(const unsigned char*& ptr)
+{
+    uint16_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    ptr += sizeof(value);
+    return value;
+}
+
+static void atlasLoadTable(const std::string& mountPoint, AtlasTable& table)
+{
+    std::string tablePath = mountPoint + "__atlas/atlas.bin";
+
+    size_t size = 0;
+    const unsigned char* data = static_cast<const unsigned char*>(execGetResource(tablePath.c_str(), &size));
+    if (!data || size < sizeof(atlas_table_header)) {
+        return; // no atlas on this mount
+    }
+
+    atlas_table_header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, "GLTA", 4) != 0) {
+        ioDebugPrint("Invalid atlas table: %s\n", tablePath.c_str());
+        return;
+    }
+
+    const unsigned char* ptr = data + sizeof(header);
+    const unsigned char* end = data + size;
+
+    for (uint32_t i = 0; i < header.page_count && ptr + 4 <= end; i++) {
+        AtlasPage page;
+        page.width = atlasRead16(ptr);
+        page.height = atlasRead16(ptr);
+        page.texture = 0;
+        table.pages.push_back(page);
+    }
+
+    for (uint32_t i = 0; i < header.entry_count && ptr + 2 <= end; i++) {
+        uint16_t pathLength = atlasRead16(ptr);
+        if (ptr + pathLength + 10 > end) {
+            break;
+        }
+        std::string path(reinterpret_cast<const char*>(ptr), pathLength);
+        ptr += pathLength;
+
+        AtlasRect rect;
+        rect.page = atlasRead16(ptr);
+        rect.x = atlasRead16(ptr);
+        rect.y = atlasRead16(ptr);
+        rect.width = atlasRead16(ptr);
+        rect.height = atlasRead16(ptr);
+        if (rect.page < static_cast<int>(table.pages.size())) {
+            table.rects[path] = rect;
+        }
+    }
+
+    ioDebugPrint("Loaded atlas for %s: %zu pages, %zu images\n", mountPoint.c_str(), table.pages.size(), table.rects.size());
+}
+
+bool glAtlasLookup(const char *path, GlAtlasRegion *region)
+{
+    if (!path || !region) {
+        return false;
+    }
+
+    // only resource mounts carry atlases
+    if (path[0] && path[1] == ':' && path[2] == '/') {
+        std::string mountPoint(path, 3);
+
+        auto it = g_atlases.find(mountPoint);
+        if (it == g_atlases.end()) {
+            it = g_atlases.emplace(mountPoint, AtlasTable()).first;
+            atlasLoadTable(mountPoint, it->second);
+        }
+
+        AtlasTable& table = it->second;
+        auto rectIt = table.rects.find(path + 3);
+        if (rectIt != table.rects.end()) {
+            const AtlasRect& rect = rectIt->second;
+            AtlasPage& page = table.pages[rect.page];
+            std::string pagePath = mountPoint + "__atlas/page" + std::to_string(rect.page) + ".png";
+            if (page.texture == 0) {
+                page.texture = glGenerateTextureAsync(pagePath.c_str(), 4);
+            }
+
+            // the caller gets a reference of its own, as with an unpacked image, so releasing it never
+            // drops the page from under the other images on it
+            region->texture = glGenerateTextureAsync(pagePath.c_str(), 4);
+            region->u0 = static_cast<float>(rect.x) / page.width;
+            region->v0 = static_cast<float>(rect.y) / page.height;
+            region->u1 = static_cast<float>(rect.x + rect.width) / page.width;
+            region->v1 = static_cast<float>(rect.y + rect.height) / page.height;
+            region->width = rect.width;
+            region->height = rect.height;
+            return true;
+        }
+    }
+
+    // not packed: fall back to a standalone texture covering the whole image
+    if (!fsFileExists(path)) {
+        return false;
+    }
+
+    region->texture = glGenerateTextureAsync(path, 4);
+    region->u0 = 0.0f;
+    region->v0 = 0.0f;
+    region->u1 = 1.0f;
+    region->v1 = 1.0f;
+    region->width = 0;  // unknown until the image has been uploaded
+    region->height = 0;
+    if (glTextureIsReady(region->texture)) {
+        glTextureGetSize(region->texture, &region->width, &region->height);
+    }
+    return region->texture != 0;
+}
@@ -0,0 +1,360 @@
+#include "glint/glint.h"
+
+#include <glad/glad.h>
+#include <stb/stb_image_write.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gl_internal.h"
+#include "jobs_internal.h"
+
+// readbacks in flight; a frame is mapped once its fence has signalled, normally one or two presents later
+#define CAPTURE_BUFFERS 3
+
+// frames handed to the job pool and not yet on disk; past this new frames are dropped instead of queueing memory
+#define CAPTURE_MAX_ENCODES 8
+
+struct CaptureSlot {
+    unsigned int buffer = 0;
+    GLsync fence = nullptr;
+    bool busy = false;
+    std::string path;
+};
+
+static CaptureSlot g_captureSlots[CAPTURE_BUFFERS];
+static int g_captureWidth = 0;
+static int g_captureHeight = 0;
+
+static std::string g_captureScreenshot;     // single frame requested for the next present
+static std::string g_capturePattern;        // printf pattern of a running recording, empty when idle
+static int g_captureRemaining = 0;          // frames left in a burst, -1 records until glCaptureStop
+static int g_captureInterval = 1;
+static int g_captureCountdown = 0;
+static int g_captureSequence = 0;
+
+static GlCaptureStats g_captureStats;
+static std::atomic<int> g_captureEncoding(0);
+static std::atomic<int> g_captureWritten(0);
+static std::atomic<int> g_captureFailed(0);
+
+static bool captureEndsWith(const std::string& path, const char* extension)
+{
+    size_t length = std::strlen(extension);
+    if (path.size() < length) {
+        return false;
+    }
+
+    for (size_t i = 0; i < length; ++i) {
+        char c = path[path.size() - length + i];
+        if (c >= 'A' && c <= 'Z') {
+            c = c - 'A' + 'a';
+        }
+        if (c != extension[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void captureCreateParent(const std::string& path)
+{
+    size_t slash = path.find_last_of('/');
+    if (slash != std::string::npos && slash > 0) {
+        fsCreateDirectory(path.substr(0, slash).c_str());
+    }
+}
+
+// runs on a job thread: flip to top row first and encode, no GL here
+static void captureEncode(std::shared_ptr<std::vector<unsigned char>> pixels, int width, int height, std::string path)
+{
+    size_t stride = static_cast<size_t>(width) * 4;
+    std::vector<unsigned char> row(stride);
+    for (int y = 0; y < height / 2; ++y) {
+        unsigned char* top = pixels->data() + y * stride;
+        unsigned char* bottom = pixels->data() + (height - 1 - y) * stride;
+        std::memcpy(row.data(), top, stride);
+        std::memcpy(top, bottom, stride);
+        std::memcpy(bottom, row.data(), stride);
+    }
+
+    // RLE targa is several times faster to write than PNG, which matters when recording every frame
+    int ok = captureEndsWith(path, ".tga")
+        ? stbi_write_tga(path.c_str(), width, height, 4, pixels->data())
+        : stbi_write_png(path.c_str(), width, height, 4, pixels->data(), static_cast<int>(stride));
+
+    if (ok) {
+        g_captureWritten++;
+    } else {
+        g_captureFailed++;
+        ioDebugPrint("Failed to write capture: %s\n", path.c_str());
+    }
+    g_captureEncoding--;
+}
+
+static void captureSubmit(std::shared_ptr<std::vector<unsigned char>> pixels, const std::string& path)
+{
+    int width = g_captureWidth;
+    int height = g_captureHeight;
+    jobsSubmit([pixels, width, height, path]() {
+        captureEncode(pixels, width, height, path);
+    });
+}
+
+static void captureRelease(CaptureSlot& slot)
+{
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    slot.busy = false;
+}
+
+// copy a finished readback out of its buffer and hand it to the encoder; wait blocks on the fence
+static bool captureCollect(CaptureSlot& slot, bool wait)
+{
+    GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? GL_TIMEOUT_IGNORED : 0);
+    if (status == GL_WAIT_FAILED) {
+        // the frame is lost, but the slot and the pending count are not, or glCaptureShutdown would wait forever
+        g_captureEncoding--;
+        g_captureFailed++;
+        ioDebugPrint("Failed to wait for capture of %s\n", slot.path.c_str());
+        captureRelease(slot);
+        return true;
+    }
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        return false;
+    }
+
+    size_t bytes = static_cast<size_t>(g_captureWidth) * g_captureHeight * 4;
+    auto pixels = std::make_shared<std::vector<unsigned char>>(bytes);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+    if (mapped) {
+        std::memcpy(pixels->data(), mapped, bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        captureSubmit(pixels, slot.path);
+    } else {
+        g_captureEncoding--;
+        g_captureFailed++;
+        ioDebugPrint("Failed to map capture buffer for %s\n", slot.path.c_str());
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    captureRelease(slot);
+    return true;
+}
+
+static void captureQueue(const std::string& path)
+{
+    g_captureStats.requested++;
+
+    if (g_captureEncoding >= CAPTURE_MAX_ENCODES) {
+        g_captureStats.dropped++;
+        return;
+    }
+
+    int prevFramebuffer = glStateGetFramebuffer();
+    glStateBindFramebuffer(0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    if (!GLAD_GL_ES_VERSION_3_0) {
+        // no pixel pack buffers: the read stalls, but the encode still happens off this thread
+        auto pixels = std::make_shared<std::vector<unsigned char>>(static_cast<size_t>(g_captureWidth) * g_captureHeight * 4);
+        glReadPixels(0, 0, g_captureWidth, g_captureHeight, GL_RGBA, GL_UNSIGNED_BYTE, pixels->data());
+        glStateBindFramebuffer(prevFramebuffer);
+        g_captureEncoding++;
+        captureSubmit(pixels, path);
+        return;
+    }
+
+    CaptureSlot* slot = nullptr;
+    for (CaptureSlot& candidate : g_captureSlots) {
+        if (!candidate.busy) {
+            slot = &candidate;
+            break;
+        }
+    }
+
+    if (!slot) {
+        // every buffer is still waiting on the GPU; waiting here would cost the frame we are trying to measure
+        glStateBindFramebuffer(prevFramebuffer);
+        g_captureStats.dropped++;
+        return;
+    }
+
+    size_t bytes = static_cast<size_t>(g_captureWidth) * g_captureHeight * 4;
+    if (!slot->buffer) {
+        glGenBuffers(1, &slot->buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+    } else {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+    }
+
+    // with a pack buffer bound glReadPixels only records the copy; the fence tells us when it is done
+    glReadPixels(0, 0, g_captureWidth, g_captureHeight, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glStateBindFramebuffer(prevFramebuffer);
+
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot->busy = true;
+    slot->path = path;
+    g_captureEncoding++;
+}
+
+void glCaptureInit(int width, int height)
+{
+    g_captureWidth = width;
+    g_captureHeight = height;
+
+    // record from the first frame, e.g. GLINT_CAPTURE=captures/frame_%05d.tga GLINT_CAPTURE_FRAMES=300
+    const char* pattern = std::getenv("GLINT_CAPTURE");
+    if (pattern && pattern[0]) {
+        const char* frames = std::getenv("GLINT_CAPTURE_FRAMES");
+        glCaptureStart(pattern, frames ? std::atoi(frames) : 0);
+    }
+}
+
+void glCapturePresent()
+{
+    if (g_captureWidth <= 0) {
+        return;
+    }
+
+    for (CaptureSlot& slot : g_captureSlots) {
+        if (slot.busy) {
+            captureCollect(slot, false);
+        }
+    }
+
+    if (!g_captureScreenshot.empty()) {
+        captureQueue(g_captureScreenshot);
+        g_captureScreenshot.clear();
+    }
+
+    if (g_capturePattern.empty()) {
+        return;
+    }
+
+    if (--g_captureCountdown > 0) {
+        return;
+    }
+    g_captureCountdown = g_captureInterval;
+
+    char path[512];
+    snprintf(path, sizeof(path), g_capturePattern.c_str(), g_captureSequence++);
+    captureQueue(path);
+
+    if (g_captureRemaining > 0 && --g_captureRemaining == 0) {
+        glCaptureStop();
+    }
+}
+
+void glCaptureShutdown()
+{
+    for (CaptureSlot& slot : g_captureSlots) {
+        if (slot.busy) {
+            captureCollect(slot, true);
+        }
+        if (slot.buffer) {
+            glDeleteBuffers(1, &slot.buffer);
+            slot.buffer = 0;
+        }
+    }
+
+    // the job pool drops queued work when it stops, so let the encoder finish first
+    while (g_captureEncoding > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool glCaptureScreenshot(const char* path)
+{
+    if (!path || !path[0]) {
+        return false;
+    }
+
+    captureCreateParent(path);
+    g_captureScreenshot = path;
+    return true;
+}
+
+// the pattern goes straight to snprintf with the frame number, so it may hold exactly one int conversion
+// (flags, width and precision allowed) and otherwise only %% escapes
+static bool captureValidPattern(const char* pattern)
+{
+    int conversions = 0;
+    for (const char* c = pattern; *c; ++c) {
+        if (*c != '%') {
+            continue;
+        }
+        if (*++c == '%') {
+            continue;
+        }
+
+        while (*c && std::strchr("-+ #0", *c)) {
+            ++c;
+        }
+        while (*c >= '0' && *c <= '9') {
+            ++c;
+        }
+        if (*c == '.') {
+            ++c;
+            while (*c >= '0' && *c <= '9') {
+                ++c;
+            }
+        }
+        if (!*c || !std::strchr("diouxX", *c)) {
+            return false;
+        }
+        conversions++;
+    }
+    return conversions == 1;
+}
+
+bool glCaptureStart(const char* pattern, int frames, int interval)
+{
+    if (!pattern || !captureValidPattern(pattern)) {
+        ioDebugPrint("Capture pattern needs exactly one frame number, e.g. captures/frame_%%05d.tga\n");
+        return false;
+    }
+
+    captureCreateParent(pattern);
+    g_capturePattern = pattern;
+    g_captureRemaining = (frames > 0) ? frames : -1;
+    g_captureInterval = (interval > 0) ? interval : 1;
+    g_captureCountdown = 1;
+    g_captureSequence = 0;
+
+    if (frames > 0) {
+        ioDebugPrint("Capturing %d frames to %s\n", frames, pattern);
+    } else {
+        ioDebugPrint("Capturing to %s until stopped\n", pattern);
+    }
+    return true;
+}
+
+void glCaptureStop()
+{
+    if (g_capturePattern.empty()) {
+        return;
+    }
+
+    ioDebugPrint("Capture stopped after %d frames\n", g_captureSequence);
+    g_capturePattern.clear();
+}
+
+GlCaptureStats glGetCaptureStats()
+{
+    GlCaptureStats stats = g_captureStats;
+    stats.written = g_captureWritten;
+    stats.failed = g_captureFailed;
+    stats.pending = g_captureEncoding;
+    return stats;
+}
@@ -1,6 +1,5 @@
 #include <fstream>
 #include <vector>
-#include <map>
 #include <cstdint>
 #include <glad/glad.h>
 
@@ -18,16 +17,26 @@ struct BMFChar {
 
 
 
-std::map<uint32_t, BMFChar> LoadBMFontBinary(const uint8_t* fileData, size_t fileSize) {
-    std::map<uint32_t, BMFChar> fontMap;
+// glyphs beyond this codepoint are dropped, it keeps a corrupt file from allocating a huge table
+#define BMF_MAX_CODEPOINT 0xFFFF
+
+// marks an empty slot in the glyph table
+#define BMF_MISSING_GLYPH 0xFFFFFFFFu
+
+// returns a table indexed by codepoint; slots without a glyph have id == BMF_MISSING_GLYPH
+std::vector<BMFChar> LoadBMFontBinary(const uint8_t* fileData, size_t fileSize) {
+    std::vector<BMFChar> glyphs;
     const uint8_t* ptr = fileData;
     const uint8_t* end = fileData + fileSize;
 
     // Validate magic + version
     if (fileSize < 4 || ptr[0] != 'B' || ptr[1] != 'M' || ptr[2] != 'F' || ptr[3] != 3)
-        return fontMap;
+        return glyphs;
     ptr += 4;
 
+    BMFChar missing = {};
+    missing.id = BMF_MISSING_GLYPH;
+
     while (ptr + sizeof(BMFHeader) <= end) {
         const BMFHeader* head = reinterpret_cast<const BMFHeader*>(ptr);
         ptr += sizeof(BMFHeader);
@@ -39,14 +48,20 @@ std::map<uint32_t, BMFChar> LoadBMFontBinary(const uint8_t* fileData, size_t fil
             int count = head->size / sizeof(BMFChar);
             for (int i = 0; i < count; ++i) {
                 const BMFChar* c = reinterpret_cast<const BMFChar*>(ptr);
-                fontMap[c->id] = *c;
                 ptr += sizeof(BMFChar);
+
+                if (c->id > BMF_MAX_CODEPOINT) continue;
+                if (c->id >= glyphs.size()) {
+                    glyphs.resize(c->id + 1, missing);
+                }
+                glyphs[c->id] = *c;
             }
+            ptr = blockEnd;
         } else {
             ptr += head->size;
         }
     }
-    return fontMap;
+    return glyphs;
 }
 
 #pragma pack(push, 1)
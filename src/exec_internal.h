@@ -79,6 +79,13 @@ struct resource_pack_file {
     resource_entry* entries;
 };
 
+// atlas rect table written by glt_execcreate, see tools/glt_execcreate/src/includes.h for the layout
+struct atlas_table_header {
+    char magic[4];
+    uint32_t page_count;
+    uint32_t entry_count;
+};
+
 inline resource_pack_file read_resource_pack(const void* data, size_t data_size)
 {
     resource_pack_file res_pack;
@@ -29,6 +29,22 @@ void fsCreateFile(const char *path)
     }
 }
 
+void fsWriteFile(const char *path, const void *data, size_t size)
+{
+    if (path[1] == ':' && path[2] == '/') {
+        ioDebugPrint("Cannot write to resource path: %s\n", path);
+        return;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        ioDebugPrint("Failed to open file for writing: %s\n", path);
+        return;
+    }
+    file.write(static_cast<const char *>(data), size);
+    ioDebugPrint("File write complete: %s (size: %d bytes)\n", path, (int)size);
+}
+
 bool fsFileExists(const char *path)
 {
     ioDebugPrint("Checking if file exists: %s\n", path);
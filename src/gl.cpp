@@ -2,23 +2,66 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
 
 #include "internal.h"
 #include "dbg_fontload.h"
+#include "gl_internal.h"
 
 static GLFWwindow* g_window = nullptr;
 static unsigned int g_debugTextTexture = 0;
-static std::map<uint32_t, BMFChar> g_debugFontMap;
+static std::vector<BMFChar> g_debugFontGlyphs;
 static unsigned int g_debugQuadVBO = 0;
 static unsigned int g_debugQuadVAO = 0;
+static unsigned int g_debugTextInstanceVBO = 0;
+
+// per-glyph instance data for glDebugText
+struct DebugGlyphInstance {
+    float x, y, width, height;   // screen rect
+    float charX, charY;          // glyph position in the font texture
+};
+
+static std::vector<DebugGlyphInstance> g_debugGlyphInstances;
+
+static int g_debugCubeMesh = 0;
 
-static unsigned int g_debugCubeVBO = 0;
-static unsigned int g_debugCubeEBO = 0;
-static unsigned int g_debugCubeVAO = 0;
+static unsigned int g_captureFramebuffer = 0;  // draw target for glCaptureFramebufferToTexture
+static unsigned int g_readFramebuffer = 0;     // screen sized copy glReadFrame scales a reduced render into
+static unsigned int g_readColorBuffer = 0;
+
+// per-instance data streamed for instanced mesh draws
+struct MeshInstance {
+    float model[16];
+    float normal[9];    // inverse transpose of the model's upper 3x3, so shaders never invert per vertex
+};
+
+static unsigned int g_meshInstanceVBO = 0;
+static std::vector<int> g_decodeWarnedShaders;  // model-uniform shaders already reported as unable to decode a cooked mesh
+static std::vector<MeshInstance> g_meshInstances;
 
 static unsigned int g_debugTextShader = 0; // Placeholder for shader program ID
 static unsigned int g_defaultShader = 0; // Placeholder for default shader program ID
+
+// debug text uniform slots, resolved once after the shader is linked
+static int g_debugTextTextureSlot = -1;
+static int g_debugTextColorSlot = -1;
+static int g_debugTextBgColorSlot = -1;
+
+// the panel; GLINT_SCREEN_SIZE=WxH overrides it. 2D content is laid out on the canvas and stretched over it
+static int g_screenWidth = 800;
+static int g_screenHeight = 480;
+
+#define CANVAS_WIDTH 800.0f
+#define CANVAS_HEIGHT 480.0f
 static int cursorY = 0; // Moved cursorY declaration here to avoid unused variable warning
 
 static double lastTimestamp = 0.0;
@@ -32,8 +75,38 @@ static void glfwErrorCallback(int code, const char* description)
     ioDebugPrint("GLFW error [%d]: %s\n", code, description ? description : "(no description)");
 }
 
-void* glSetup()
+static bool glHeadlessRequested()
+{
+    const char* value = std::getenv("GLINT_HEADLESS");
+    return value && value[0] && std::strcmp(value, "0") != 0;
+}
+
+static void glRendererInit();
+
+static void glReadScreenSize()
 {
+    const char* value = std::getenv("GLINT_SCREEN_SIZE");
+    int width = 0, height = 0;
+    if (value && sscanf(value, "%dx%d", &width, &height) == 2 && width > 0 && height > 0) {
+        g_screenWidth = width;
+        g_screenHeight = height;
+    }
+}
+
+void* glSetup(bool headless)
+{
+    glReadScreenSize();
+
+    if (headless || glHeadlessRequested()) {
+        void* context = glHeadlessInit(g_screenWidth, g_screenHeight);
+        if (!context) {
+            return nullptr;
+        }
+
+        glRendererInit();
+        return context;
+    }
+
     glfwSetErrorCallback(glfwErrorCallback);
 
     if (!glfwInit()) {
@@ -48,12 +121,12 @@ void* glSetup()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
 
     // 800x480 is a PSP-like resolution, good starting point
-    GLFWwindow* window = glfwCreateWindow(800, 480, "Glint", nullptr, nullptr);
+    GLFWwindow* window = glfwCreateWindow(g_screenWidth, g_screenHeight, "Glint", nullptr, nullptr);
     if (!window) {
         ioDebugPrint("OpenGL ES 3.0 context unavailable; retrying with OpenGL ES 2.0\n");
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
-        window = glfwCreateWindow(800, 480, "Glint", nullptr, nullptr);
+        window = glfwCreateWindow(g_screenWidth, g_screenHeight, "Glint", nullptr, nullptr);
     }
 
     if (!window) {
@@ -75,12 +148,25 @@ void* glSetup()
 
     glfwSwapInterval(1);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glRendererInit();
+    return window;
+}
+
+// everything after context creation, shared by the window and headless backends
+static void glRendererInit()
+{
+    glStateInvalidate();
+    glStateBindFramebuffer(0);
+    glStateViewport(0, 0, g_screenWidth, g_screenHeight);
+    glStateEnable(GL_BLEND, true);
+    glStateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glGlobalsInit(g_screenWidth, g_screenHeight);
+    glGlobalsSetCanvas(CANVAS_WIDTH, CANVAS_HEIGHT);
 
     // setup debug text texture
     g_debugTextTexture = glGenerateTexture(bmfont_0, sizeof(bmfont_0), 3);
-    g_debugFontMap = LoadBMFontBinary(bmfont, sizeof(bmfont));
+    g_debugFontGlyphs = LoadBMFontBinary(bmfont, sizeof(bmfont));
 
     ioDebugPrint("Debug text texture generated with ID: %u\n", g_debugTextTexture);
 
@@ -103,38 +189,43 @@ void* glSetup()
         glBindBuffer(GL_ARRAY_BUFFER, 0);
 
         glGenVertexArrays(1, &g_debugQuadVAO);
-        glBindVertexArray(g_debugQuadVAO);
+        glStateBindVertexArray(g_debugQuadVAO);
         glBindBuffer(GL_ARRAY_BUFFER, g_debugQuadVBO);
         glEnableVertexAttribArray(0); // Position
         glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(1); // TexCoords
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
-    }
 
-    {
-        glGenBuffers(1, &g_debugCubeVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, g_debugCubeVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+        // one instance per glyph, filled by glDebugText
+        glGenBuffers(1, &g_debugTextInstanceVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, g_debugTextInstanceVBO);
+        glEnableVertexAttribArray(2); // Screen rect
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(DebugGlyphInstance), (void*)offsetof(DebugGlyphInstance, x));
+        glVertexAttribDivisor(2, 1);
+        glEnableVertexAttribArray(3); // Glyph position in font texture
+        glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(DebugGlyphInstance), (void*)offsetof(DebugGlyphInstance, charX));
+        glVertexAttribDivisor(3, 1);
+
         glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glStateBindVertexArray(0);
+    }
 
-        glGenBuffers(1, &g_debugCubeEBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_debugCubeEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cubeIndices), cubeIndices, GL_STATIC_DRAW);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    // shared by every instanced mesh, refilled on each draw
+    glGenBuffers(1, &g_meshInstanceVBO);
 
-        glGenVertexArrays(1, &g_debugCubeVAO);
-        glBindVertexArray(g_debugCubeVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, g_debugCubeVBO);
-        glEnableVertexAttribArray(0); // Position
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(1); // Normal
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(2); // TexCoords
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+    {
+        GlMeshAttribute cubeAttributes[3];
+        cubeAttributes[0].location = 0; // Position
+        cubeAttributes[0].components = 3;
+        cubeAttributes[0].offset = 0;
+        cubeAttributes[1].location = 1; // Normal
+        cubeAttributes[1].components = 3;
+        cubeAttributes[1].offset = 3 * sizeof(float);
+        cubeAttributes[2].location = 2; // TexCoords
+        cubeAttributes[2].components = 2;
+        cubeAttributes[2].offset = 6 * sizeof(float);
+
+        g_debugCubeMesh = glMeshCreate(cubeAttributes, 3, 8 * sizeof(float), cubeVertices, 24, cubeIndices, 36, sizeof(unsigned int));
     }
 
     // generate shader for debug text rendering
@@ -144,25 +235,17 @@ void* glSetup()
         #version 300 es
         layout(location = 0) in vec2 aPos;
         layout(location = 1) in vec2 aTexCoord;
+        layout(location = 2) in vec4 aRect;
+        layout(location = 3) in vec2 aCharPosition;
         
         out vec2 TexCoord;
 
-        uniform vec2 position;
-        uniform vec2 scale;
-
-        #define SCREEN_WIDTH 800.0
-        #define SCREEN_HEIGHT 480.0
-        
         void main() {
 
             // generate screen-space position
-            vec2 scaledPos = aPos * scale;
-            vec2 screenPos = position + scaledPos;
-            vec2 ndcPos = (screenPos / vec2(SCREEN_WIDTH, SCREEN_HEIGHT)) * 2.0 - 1.0;
-            ndcPos.y = -ndcPos.y; // Flip Y for OpenGL coordinate system
-
-            gl_Position = vec4(ndcPos, 0.0, 1.0);
-            TexCoord = aTexCoord;
+            vec2 scaledPos = aPos * aRect.zw;
+            gl_Position = glintCanvasToClip(aRect.xy + scaledPos);
+            TexCoord = (aTexCoord * vec2(8,16) + aCharPosition) / vec2(256, 64);
         }
         )",
         // Fragment shader
@@ -175,22 +258,23 @@ void* glSetup()
         
         out vec4 FragColor;
 
-        uniform vec2 char_position;
-
         uniform vec4 textColor;
         uniform vec4 bgColor;
         
         void main() {
-            vec2 adjustedTexCoord = (TexCoord * vec2(8,16) + char_position) / vec2(256, 64);
-            float alpha = texture(textTexture, adjustedTexCoord).r;
+            float alpha = texture(textTexture, TexCoord).r;
 
             FragColor = mix(bgColor, textColor, alpha);
 
-            //FragColor = vec4(adjustedTexCoord, 0.0, 1.0); // Debug: visualize texture coordinates
+            //FragColor = vec4(TexCoord, 0.0, 1.0); // Debug: visualize texture coordinates
         }
         )"
     );
 
+    g_debugTextTextureSlot = glShaderGetUniform(g_debugTextShader, "textTexture");
+    g_debugTextColorSlot = glShaderGetUniform(g_debugTextShader, "textColor");
+    g_debugTextBgColorSlot = glShaderGetUniform(g_debugTextShader, "bgColor");
+
     // generate shader for default rendering
     g_defaultShader = glGenerateShader(
         // Vertex shader
@@ -199,20 +283,28 @@ void* glSetup()
         layout(location = 0) in vec3 aPos;
         layout(location = 1) in vec3 aNormal;
         layout(location = 2) in vec2 aTexCoord;
+        layout(location = 3) in mat4 aModel;        // per instance
+        layout(location = 7) in mat3 aNormalMatrix; // per instance
         
         out vec3 Position;
         out vec3 Normal;
         out vec2 TexCoord;
 
-        uniform mat4 model;
-        uniform mat4 view;
-        uniform mat4 projection;
+        uniform bool octahedralNormals; // cooked meshes store normals as two snorm components
+
+        vec3 octahedralDecode(vec2 e) {
+            vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+            float t = max(-n.z, 0.0);
+            n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+            return normalize(n);
+        }
 
         void main() {
             Position = aPos;
-            Normal = mat3(transpose(inverse(model))) * aNormal; // Transform normal to world space
+            vec3 normal = octahedralNormals ? octahedralDecode(aNormal.xy) : aNormal;
+            Normal = aNormalMatrix * normal; // Transform normal to world space
             TexCoord = aTexCoord;
-            gl_Position = projection * view * model * vec4(aPos, 1.0);
+            gl_Position = glintProjection * glintView * aModel * vec4(aPos, 1.0);
         }
         )",
         // Fragment shader
@@ -233,18 +325,30 @@ void* glSetup()
         )"
     );
 
-    return window;
+    glSpriteBatchInit();
+    glCaptureInit(g_screenWidth, g_screenHeight);
+    glResolutionInit(g_screenWidth, g_screenHeight);
 }
 
 void glShutdown() {
 
-    
+    glCaptureShutdown();
+    glDynamicResolutionDisable();
+
+    if (glIsHeadless()) {
+        glHeadlessShutdown();
+        return;
+    }
 
     glfwTerminate();
 }
 
 bool glRunning()
 {
+    if (glIsHeadless()) {
+        return glHeadlessRunning();
+    }
+
     return !glfwWindowShouldClose((GLFWwindow*)glGetContext());
 }
 
@@ -252,6 +356,11 @@ void glAttach(void *ctx)
 {
    ioDebugPrint("glattach called with ctx: %p\n", ctx);
 
+    if (glIsHeadless()) {
+        glHeadlessAttach();
+        glStateInvalidate();
+        return;
+    }
 
     GLFWwindow* window = static_cast<GLFWwindow*>(ctx);
     if (!window) {
@@ -267,28 +376,49 @@ void glAttach(void *ctx)
 
     glfwMakeContextCurrent(window);
 
+    // whoever had the context last may have changed anything
+    glStateInvalidate();
+
     ioDebugPrint("OpenGL context attached successfully\n");
 }
 
 void glPresent()
 {
-    if (!g_window) {
+    if (!g_window && !glIsHeadless()) {
         return;
     }
 
-    hidFlush(); // Flush input state before checking if we should close
-    glfwSwapBuffers(g_window);
+    glSpriteBatchFlush();
+    glResolutionResolve();
+    glCapturePresent();
+
+    if (glIsHeadless()) {
+        glHeadlessPresent();
+    } else {
+        hidFlush(); // Flush input state before checking if we should close
+        glfwSwapBuffers(g_window);
+    }
     cursorY = 0; // Reset cursor Y position after presenting
 
 
 
-    double currentTimestamp = glfwGetTime();
+    double currentTimestamp = glGetTime();
     deltaTime = currentTimestamp - lastTimestamp;
     lastTimestamp = currentTimestamp;
+
+    glGlobalsSetTime(static_cast<float>(currentTimestamp));
+    glResolutionUpdate(deltaTime);
+    glTextureUploadPump();
+    glRenderTargetPump();
+    glStateEndFrame();
 }
 
 double glGetTime()
 {
+    if (glIsHeadless()) {
+        return glHeadlessTime();
+    }
+
     return glfwGetTime();
 }
 
@@ -297,143 +427,6 @@ double glGetDeltaTime()
     return deltaTime;
 }
 
-int glGenerateShader(const char *vertexSrc, const char *fragmentSrc)
-{
-    unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vertexSrc, nullptr);
-    glCompileShader(vertex);
-    
-    int success;
-    char infoLog[512];
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertex, 512, nullptr, infoLog);
-        ioDebugPrint("Vertex shader compilation failed: %s\n", infoLog);
-        glDeleteShader(vertex);
-        return 0;
-    }
-    
-    unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fragmentSrc, nullptr);
-    glCompileShader(fragment);
-    
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragment, 512, nullptr, infoLog);
-        ioDebugPrint("Fragment shader compilation failed: %s\n", infoLog);
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-        return 0;
-    }
-    
-    unsigned int program = glCreateProgram();
-    glAttachShader(program, vertex);
-    glAttachShader(program, fragment);
-    glLinkProgram(program);
-    
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(program, 512, nullptr, infoLog);
-        ioDebugPrint("Shader program linking failed: %s\n", infoLog);
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-        glDeleteProgram(program);
-        return 0;
-    }
-    
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
-    
-    return program;
-}
-
-int glGenerateTexture(int width, int height, const unsigned char *data, int desiredChannels)
-{
-    // 4. Standard OpenGLES Texture Upload
-    GLuint tex;
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
-    
-    // Critical: Font textures often have non-power-of-two widths
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-    GLenum format = (desiredChannels == 4) ? GL_RGBA : GL_RGB;
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    return tex;
-}
-int glGenerateTexture(const unsigned char *data, int dataSize, int desired_channels)
-{
-    
-    int width, height, channels_in_file;
-    // Request 4 components (RGBA) for consistency, but you can use 0 to let it decide.
-
-    ioDebugPrint("Loading texture from memory (size: %d bytes, desired channels: %d)...\n", dataSize, desired_channels);
- 
-    unsigned char* image_data = stbi_load_from_memory(
-        data,
-        dataSize,
-        &width,
-        &height,
-        &channels_in_file,
-        desired_channels
-    );
-
-    if (image_data == NULL) {
-        ioDebugPrint("Failed to load TGA image from memory: %s\n", stbi_failure_reason());
-        return 0;
-    }
-
-    // 4. Standard OpenGLES Texture Upload
-    GLuint tex;
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
-
-    ioDebugPrint("Texture loaded: %dx%d, channels in file: %d\n", width, height, channels_in_file);
-    
-    // Critical: Font textures often have non-power-of-two widths
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-    // Use desired_channels (what stbi actually returned), not channels_in_file (what the file originally had)
-    int actual_channels = (desired_channels != 0) ? desired_channels : channels_in_file;
-    GLenum format = (actual_channels == 4) ? GL_RGBA : GL_RGB;
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, image_data);
-
-    ioDebugPrint("Texture generated with ID: %u\n", tex);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(image_data);
-
-    ioDebugPrint("Texture upload complete\n");
-
-    return tex;
-}
-
-int glGenerateTexture(const char *filePath, int desiredChannels)
-{
-    ioDebugPrint("Loading texture from file: %s\n", filePath);
-
-    size_t size = 0;
-    const void* fileData = fsReadFile(filePath, &size);
-
-    if (!fileData) {
-        ioDebugPrint("Failed to read file for texture: %s\n", filePath);
-        return 0;
-    }
-
-    if (size > static_cast<size_t>(std::numeric_limits<int>::max())) {
-        ioDebugPrint("Texture file too large to decode safely: %s (size: %zu bytes)\n", filePath, size);
-        return 0;
-    }
-
-    return glGenerateTexture((const unsigned char*)fileData, static_cast<int>(size), desiredChannels);
-}
-
 void glDebugText(const char *text)
 {
     glDebugTextFmt("%s", text);
@@ -463,101 +456,394 @@ void glDebugTextFmt(unsigned long color, unsigned long bg, const char *format, .
 
 void glDebugText(unsigned long color, unsigned long bg, const char *text)
 {
-    // iterate through the text and render each character using g_debugFontMap and g_debugTextTexture
+    // lay the whole string out as glyph instances, then draw it in one call
+
+    glSpriteBatchFlush();
 
     int cursorX = 0;
 
     
     float textScale = 4.0f;
 
+    g_debugGlyphInstances.clear();
+
     for (const char* p = text; *p; ++p) {
-        char c = *p;
+        unsigned char c = static_cast<unsigned char>(*p);
         if (c == '\n') {
             // Handle newlines (move to next line)
-            // This is a simplified example, you would need to track cursor position
             cursorX = 0;
             cursorY += 16 * textScale; // Move down by one line height (assuming 16px line height)
             continue;
         }
 
-        auto it = g_debugFontMap.find(c);
-        if (it != g_debugFontMap.end()) {
-            const BMFChar& ch = it->second;
-            // Render character 'ch' using g_debugTextTexture and the quad defined in g_debugQuadVBO
-            // You would need to set up your shader and draw calls here
-
-            glBindVertexArray(g_debugQuadVAO);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, g_debugTextTexture);
-
-            glUseProgram(g_debugTextShader);
-            // Set shader uniforms for position, scale, color, character position, etc.
-            glUniform2f(glGetUniformLocation(g_debugTextShader, "position"), cursorX + ch.xoffset, cursorY - ch.yoffset);
-            glUniform2f(glGetUniformLocation(g_debugTextShader, "char_position"), ch.x, ch.y);
-            glUniform2f(glGetUniformLocation(g_debugTextShader, "scale"), ch.width * textScale, ch.height * textScale);
-            glUniform1i(glGetUniformLocation(g_debugTextShader, "texture"), 0);
-            glUniform4f(glGetUniformLocation(g_debugTextShader, "textColor"), 
-                ((color >> 24) & 0xFF) / 255.0f, 
-                ((color >> 16) & 0xFF) / 255.0f, 
-                ((color >> 8) & 0xFF) / 255.0f, 
-                (color & 0xFF) / 255.0f
-            );
-
-                glUniform4f(glGetUniformLocation(g_debugTextShader, "bgColor"), 
-                ((bg >> 24) & 0xFF) / 255.0f, 
-                ((bg >> 16) & 0xFF) / 255.0f, 
-                ((bg >> 8) & 0xFF) / 255.0f, 
-                (bg & 0xFF) / 255.0f
-            );
-
-
-            glDrawArrays(GL_TRIANGLES, 0, 6);
+        if (c < g_debugFontGlyphs.size() && g_debugFontGlyphs[c].id != BMF_MISSING_GLYPH) {
+            const BMFChar& ch = g_debugFontGlyphs[c];
+
+            DebugGlyphInstance glyph;
+            glyph.x = static_cast<float>(cursorX + ch.xoffset);
+            glyph.y = static_cast<float>(cursorY - ch.yoffset);
+            glyph.width = ch.width * textScale;
+            glyph.height = ch.height * textScale;
+            glyph.charX = ch.x;
+            glyph.charY = ch.y;
+            g_debugGlyphInstances.push_back(glyph);
 
             cursorX += ch.xadvance * textScale;
         } else {
-            // Character not found in font map, skip or render a placeholder
+            // Character not found in font, skip it
             cursorX += 8 * textScale; // Move cursor forward by a default width
         }
     }
 
     cursorY += 16 * textScale; // Move down by one line height (assuming 16px line height)
+
+    if (g_debugGlyphInstances.empty()) {
+        return;
+    }
+
+    size_t instanceBytes = g_debugGlyphInstances.size() * sizeof(DebugGlyphInstance);
+    glBindBuffer(GL_ARRAY_BUFFER, g_debugTextInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instanceBytes, nullptr, GL_STREAM_DRAW); // orphan
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instanceBytes, g_debugGlyphInstances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glStateBindVertexArray(g_debugQuadVAO);
+    glStateBindTexture(0, g_debugTextTexture);
+
+    glShaderUse(g_debugTextShader);
+    glShaderSetInt(g_debugTextShader, g_debugTextTextureSlot, 0);
+    glShaderSetVec4(g_debugTextShader, g_debugTextColorSlot, vec4(
+        ((color >> 24) & 0xFF) / 255.0f, 
+        ((color >> 16) & 0xFF) / 255.0f, 
+        ((color >> 8) & 0xFF) / 255.0f, 
+        (color & 0xFF) / 255.0f
+    ));
+
+    glShaderSetVec4(g_debugTextShader, g_debugTextBgColorSlot, vec4(
+        ((bg >> 24) & 0xFF) / 255.0f, 
+        ((bg >> 16) & 0xFF) / 255.0f, 
+        ((bg >> 8) & 0xFF) / 255.0f, 
+        (bg & 0xFF) / 255.0f
+    ));
+
+    glGlobalsSync();
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(g_debugGlyphInstances.size()));
 }
 
 void *glGetContext()
 {
+    if (glIsHeadless()) {
+        return glHeadlessContext();
+    }
+
     return g_window;
 }
 
+bool glReadFrame(unsigned char *rgba)
+{
+    if (!rgba || (!g_window && !glIsHeadless())) {
+        return false;
+    }
+
+    // sprites still queued are part of the frame
+    glSpriteBatchFlush();
+
+    int prevFramebuffer = glStateGetFramebuffer();
+    glStateBindFramebuffer(0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    // with dynamic resolution only part of framebuffer 0 holds the frame, so it is scaled up the way glPresent does
+    int renderWidth = g_screenWidth, renderHeight = g_screenHeight;
+    glGetRenderSize(&renderWidth, &renderHeight);
+    if (renderWidth != g_screenWidth || renderHeight != g_screenHeight) {
+        if (!g_readFramebuffer) {
+            glGenRenderbuffers(1, &g_readColorBuffer);
+            glBindRenderbuffer(GL_RENDERBUFFER, g_readColorBuffer);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, g_screenWidth, g_screenHeight);
+            glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+            glGenFramebuffers(1, &g_readFramebuffer);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, g_readFramebuffer);
+            glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, g_readColorBuffer);
+        }
+
+        int defaultFramebuffer = glStateGetFramebuffer();
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, g_readFramebuffer);
+        glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, g_screenWidth, g_screenHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, g_readFramebuffer);
+        glReadPixels(0, 0, g_screenWidth, g_screenHeight, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+
+        // put both bindings back to what the state cache believes is bound
+        glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebuffer);
+    } else {
+        glReadPixels(0, 0, g_screenWidth, g_screenHeight, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    }
+    glStateBindFramebuffer(prevFramebuffer);
+
+    // GL rows start at the bottom, images start at the top
+    size_t stride = static_cast<size_t>(g_screenWidth) * 4;
+    std::vector<unsigned char> row(stride);
+    for (int y = 0; y < g_screenHeight / 2; ++y) {
+        unsigned char* top = rgba + y * stride;
+        unsigned char* bottom = rgba + (g_screenHeight - 1 - y) * stride;
+        std::memcpy(row.data(), top, stride);
+        std::memcpy(top, bottom, stride);
+        std::memcpy(bottom, row.data(), stride);
+    }
+
+    return true;
+}
+
+int glCaptureFramebufferToTexture(int texture, float scale)
+{
+    if (!g_window && !glIsHeadless()) {
+        return 0;
+    }
+
+    if (!GLAD_GL_ES_VERSION_3_0) {
+        ioDebugPrint("glCaptureFramebufferToTexture needs OpenGL ES 3.0 (glBlitFramebuffer)\n");
+        return 0;
+    }
+
+    scale = std::min(std::max(scale, 0.0f), 1.0f);
+    int width = std::max(1, static_cast<int>(g_screenWidth * scale));
+    int height = std::max(1, static_cast<int>(g_screenHeight * scale));
+
+    // sprites still queued are part of the frame
+    glSpriteBatchFlush();
+
+    int textureWidth = 0, textureHeight = 0;
+    bool reuse = texture && glTextureGetSize(texture, &textureWidth, &textureHeight) && textureWidth == width && textureHeight == height;
+    if (!reuse) {
+        if (texture && textureWidth) {
+            glReleaseTexture(texture);
+        }
+
+        unsigned int tex;
+        glGenTextures(1, &tex);
+        glStateBindTexture(0, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTextureRegister(tex, width, height, static_cast<size_t>(width) * height * 4, false);
+        texture = tex;
+    }
+
+    if (!g_captureFramebuffer) {
+        glGenFramebuffers(1, &g_captureFramebuffer);
+    }
+
+    int prevFramebuffer = glStateGetFramebuffer();
+    glStateBindFramebuffer(0);
+    int defaultFramebuffer = glStateGetFramebuffer();
+
+    // with dynamic resolution only part of framebuffer 0 holds the frame
+    int sourceWidth = g_screenWidth, sourceHeight = g_screenHeight;
+    glGetRenderSize(&sourceWidth, &sourceHeight);
+
+    // the destination rows are given bottom-up, so the blit flips the image into texture order
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, g_captureFramebuffer);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    glBlitFramebuffer(0, 0, sourceWidth, sourceHeight, 0, height, width, 0,
+                      GL_COLOR_BUFFER_BIT, (width == sourceWidth && height == sourceHeight) ? GL_NEAREST : GL_LINEAR);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+    glTextureTouch(texture);
+
+    // put the draw binding back to what the state cache believes is bound
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, defaultFramebuffer);
+    glStateBindFramebuffer(prevFramebuffer);
+
+    return texture;
+}
+
+bool glSaveFrame(const char *path)
+{
+    std::vector<unsigned char> pixels(static_cast<size_t>(g_screenWidth) * g_screenHeight * 4);
+    if (!glReadFrame(pixels.data())) {
+        ioDebugPrint("Failed to read back frame for %s\n", path);
+        return false;
+    }
+
+    if (!stbi_write_png(path, g_screenWidth, g_screenHeight, 4, pixels.data(), g_screenWidth * 4)) {
+        ioDebugPrint("Failed to write frame: %s\n", path);
+        return false;
+    }
+
+    ioDebugPrint("Frame saved: %s\n", path);
+    return true;
+}
+
 void glQuadDraw(float x, float y, float width, float height, int shader)
 {
-    glBindVertexArray(g_debugQuadVAO);
-    glUseProgram(shader);
+    // immediate quad: the caller has already bound its program state, so draw it straight away
+    GlSprite sprite;
+    sprite.x = x;
+    sprite.y = y;
+    sprite.width = width;
+    sprite.height = height;
+    sprite.texture = -1;
+    sprite.shader = shader;
+
+    glSpriteBatchFlush();
+    glSpriteBatchDraw(sprite);
+    glSpriteBatchFlush();
+}
 
-    // Set shader uniforms for position, scale, color, character position, etc.
-    glUniform2f(glGetUniformLocation(shader, "position"), x, y);
-    glUniform2f(glGetUniformLocation(shader, "scale"), width, height);
+void glInstanceAttribs()
+{
+    // mat4 and mat3 attributes take one location per column
+    glBindBuffer(GL_ARRAY_BUFFER, g_meshInstanceVBO);
+    for (int column = 0; column < 4; ++column) {
+        glEnableVertexAttribArray(3 + column); // Model matrix
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(MeshInstance), (void*)(offsetof(MeshInstance, model) + column * 4 * sizeof(float)));
+        glVertexAttribDivisor(3 + column, 1);
+    }
+    for (int column = 0; column < 3; ++column) {
+        glEnableVertexAttribArray(7 + column); // Normal matrix
+        glVertexAttribPointer(7 + column, 3, GL_FLOAT, GL_FALSE, sizeof(MeshInstance), (void*)(offsetof(MeshInstance, normal) + column * 3 * sizeof(float)));
+        glVertexAttribDivisor(7 + column, 1);
+    }
+}
 
+// inverse transpose of the upper 3x3: the cofactor matrix divided by the determinant
+static void glNormalMatrix(const mat4& model, float* normal)
+{
+    const float* m = model.m;
+    float a = m[0], b = m[4], c = m[8];
+    float d = m[1], e = m[5], f = m[9];
+    float g = m[2], h = m[6], i = m[10];
+
+    float cofactor[9] = {
+        e * i - f * h, c * h - b * i, b * f - c * e,
+        f * g - d * i, a * i - c * g, c * d - a * f,
+        d * h - e * g, b * g - a * h, a * e - b * d
+    };
+
+    float det = a * cofactor[0] + d * cofactor[1] + g * cofactor[2];
+    float invDet = (fabsf(det) > 1e-12f) ? 1.0f / det : 1.0f; // degenerate scale keeps the direction only
+
+    // the cofactors above are stored column-major, matching the mat3 attribute layout
+    for (int k = 0; k < 9; ++k) {
+        normal[k] = cofactor[k] * invDet;
+    }
+}
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+// fold the position dequantization into the model matrix: model * translate(offset) * scale(scale)
+static void glDecodeModel(const mat4& model, const MeshDecode& decode, float* out)
+{
+    const float* m = model.m;
+    const vec3& scale = decode.positionScale;
+    const vec3& offset = decode.positionOffset;
+    for (int row = 0; row < 4; ++row) {
+        out[0 + row] = m[0 + row] * scale.x;
+        out[4 + row] = m[4 + row] * scale.y;
+        out[8 + row] = m[8 + row] * scale.z;
+        out[12 + row] = m[0 + row] * offset.x + m[4 + row] * offset.y + m[8 + row] * offset.z + m[12 + row];
+    }
 }
 
-void glCubeDraw(mat4 model, int shader)
+void glInstancedDraw(int vertexArray, int indexCount, unsigned int indexType, const mat4* models, int count, int shader, const MeshDecode* decode)
 {
+    if (!models || count <= 0) {
+        return;
+    }
 
     if (shader == 0) {
         shader = g_defaultShader;
     }
 
-    glBindVertexArray(g_debugCubeVAO);
-    glUseProgram(shader);
+    glSpriteBatchFlush();
+    glGlobalsSync();
+
+    glStateBindVertexArray(vertexArray);
+    glShaderUse(shader);
+
+    // shaders that predate the globals block still get view/projection as plain uniforms
+    glShaderSetMat4(shader, glShaderBuiltinSlot(shader, SHADER_SLOT_VIEW), viewMatrix);
+    glShaderSetMat4(shader, glShaderBuiltinSlot(shader, SHADER_SLOT_PROJECTION), projectionMatrix);
+    glShaderSetVec3(shader, glShaderBuiltinSlot(shader, SHADER_SLOT_COLOR), vec3(1.0f, 1.0f, 1.0f));
+    glShaderSetInt(shader, glShaderBuiltinSlot(shader, SHADER_SLOT_OCTAHEDRAL_NORMALS), (decode && decode->octahedralNormals) ? 1 : 0);
+
+    // shaders with a model uniform read no instance attributes, so they are drawn one call per object. they tend to
+    // derive normals from the model matrix, so it stays the caller's and the decode goes in uniforms of its own
+    int modelSlot = glShaderBuiltinSlot(shader, SHADER_SLOT_MODEL);
+    if (modelSlot >= 0) {
+        int scaleSlot = glShaderBuiltinSlot(shader, SHADER_SLOT_POSITION_SCALE);
+        int offsetSlot = glShaderBuiltinSlot(shader, SHADER_SLOT_POSITION_OFFSET);
+        glShaderSetVec3(shader, scaleSlot, decode ? decode->positionScale : vec3(1.0f, 1.0f, 1.0f));
+        glShaderSetVec3(shader, offsetSlot, decode ? decode->positionOffset : vec3(0.0f, 0.0f, 0.0f));
+
+        if (decode && std::find(g_decodeWarnedShaders.begin(), g_decodeWarnedShaders.end(), shader) == g_decodeWarnedShaders.end()) {
+            const vec3& scale = decode->positionScale;
+            const vec3& offset = decode->positionOffset;
+            bool quantized = scale.x != 1.0f || scale.y != 1.0f || scale.z != 1.0f || offset.x != 0.0f || offset.y != 0.0f || offset.z != 0.0f;
+            if ((quantized && (scaleSlot < 0 || offsetSlot < 0)) ||
+                (decode->octahedralNormals && glShaderBuiltinSlot(shader, SHADER_SLOT_OCTAHEDRAL_NORMALS) < 0)) {
+                ioDebugPrint("Shader %d takes a model uniform but cannot decode cooked meshes (positionScale, positionOffset, "
+                             "octahedralNormals); draw them with the built-in shader or one reading instance attributes\n", shader);
+                g_decodeWarnedShaders.push_back(shader);
+            }
+        }
+
+        for (int i = 0; i < count; ++i) {
+            glShaderSetMat4(shader, modelSlot, models[i]);
+            glDrawElements(GL_TRIANGLES, indexCount, indexType, 0);
+        }
+        return;
+    }
+
+    g_meshInstances.resize(count);
+    for (int i = 0; i < count; ++i) {
+        MeshInstance& instance = g_meshInstances[i];
+        std::memcpy(instance.model, models[i].m, sizeof(instance.model));
+        glNormalMatrix(models[i], instance.normal);
 
-    glUniformMatrix4fv(glGetUniformLocation(shader, "model"), 1, GL_FALSE, model.m);
-    glUniformMatrix4fv(glGetUniformLocation(shader, "view"), 1, GL_FALSE, viewMatrix.m);
-    glUniformMatrix4fv(glGetUniformLocation(shader, "projection"), 1, GL_FALSE, projectionMatrix.m);
-    glUniform3f(glGetUniformLocation(shader, "color"), 1.0f, 1.0f, 1.0f);
+        if (decode) {
+            glDecodeModel(models[i], *decode, instance.model);
+        }
+    }
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_debugCubeEBO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    size_t instanceBytes = count * sizeof(MeshInstance);
+    glBindBuffer(GL_ARRAY_BUFFER, g_meshInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instanceBytes, nullptr, GL_STREAM_DRAW); // orphan
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instanceBytes, g_meshInstances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDrawElementsInstanced(GL_TRIANGLES, indexCount, indexType, 0, count);
+}
+
+void glCubeDraw(mat4 model, int shader)
+{
+    glMeshDraw(g_debugCubeMesh, model, shader);
+}
+
+void glCubeDrawInstanced(const mat4* models, int count, int shader)
+{
+    glMeshDrawInstanced(g_debugCubeMesh, models, count, shader);
+}
+
+void glCanvasSetSize(float width, float height)
+{
+    if (width <= 0.0f || height <= 0.0f) {
+        return;
+    }
+
+    // sprites already queued were positioned on the old canvas
+    glSpriteBatchFlush();
+    glGlobalsSetCanvas(width, height);
+}
+
+vec2 glCanvasGetSize()
+{
+    return glGlobalsGetCanvas();
+}
+
+void glGetScreenSize(int* width, int* height)
+{
+    if (width) *width = g_screenWidth;
+    if (height) *height = g_screenHeight;
 }
 
 void glCameraSetOrtho(float left, float right, float bottom, float top)
@@ -569,6 +855,8 @@ void glCameraSetOrtho(float left, float right, float bottom, float top)
     projectionMatrix.m[12] = -(right + left) / (right - left);
     projectionMatrix.m[13] = -(top + bottom) / (top - bottom);
     projectionMatrix.m[15] = 1.0f;
+
+    glGlobalsSetCamera(projectionMatrix, viewMatrix);
 }
 
 void glCameraSetPerspective(float fovY, float aspect, float nearZ, float farZ)
@@ -580,6 +868,8 @@ void glCameraSetPerspective(float fovY, float aspect, float nearZ, float farZ)
     projectionMatrix.m[10] = (farZ + nearZ) / (nearZ - farZ);
     projectionMatrix.m[11] = -1.0f;
     projectionMatrix.m[14] = (2.0f * farZ * nearZ) / (nearZ - farZ);
+
+    glGlobalsSetCamera(projectionMatrix, viewMatrix);
 }
 
 void glCameraSetView(vec3 eye, vec3 center, vec3 up)
@@ -601,4 +891,6 @@ void glCameraSetView(vec3 eye, vec3 center, vec3 up)
     viewMatrix.m[12] = -s.dot(eye);
     viewMatrix.m[13] = -u.dot(eye);
     viewMatrix.m[14] = f.dot(eye);
+
+    glGlobalsSetCamera(projectionMatrix, viewMatrix);
 }
\ No newline at end of file
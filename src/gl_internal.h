@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "glint/types/math.h"
+
+// internal hooks shared between the gl translation units (gl.cpp, sprite.cpp, shader.cpp, ...)
+
+// sprite batch
+void glSpriteBatchInit();
+
+// shader programs: uniforms every quad/mesh shader tends to have, resolved once at link time
+enum ShaderSlot {
+    SHADER_SLOT_POSITION,
+    SHADER_SLOT_SCALE,
+    SHADER_SLOT_ALPHA,
+    SHADER_SLOT_COLOR,
+    SHADER_SLOT_TEX,
+    SHADER_SLOT_MODEL,
+    SHADER_SLOT_VIEW,
+    SHADER_SLOT_PROJECTION,
+    SHADER_SLOT_OCTAHEDRAL_NORMALS,
+    SHADER_SLOT_POSITION_SCALE,     // quantized mesh positions, for shaders that take a model uniform
+    SHADER_SLOT_POSITION_OFFSET,
+    SHADER_SLOT_COUNT
+};
+
+int glShaderBuiltinSlot(int shader, ShaderSlot slot);
+
+// program binary cache, keyed by both sources and the driver; Load returns 0 on a miss or a rejected blob
+unsigned int glShaderCacheLoad(const std::string& vertexSource, const std::string& fragmentSource);
+void glShaderCacheStore(unsigned int program, const std::string& vertexSource, const std::string& fragmentSource, double compileMs);
+
+// instanced meshes: the VAO must have been set up with glInstanceAttribs (locations 3-6 model, 7-9 normal matrix)
+struct MeshDecode {
+    vec3 positionScale = vec3(1.0f, 1.0f, 1.0f);   // quantized positions: object = offset + value * scale
+    vec3 positionOffset;
+    bool octahedralNormals = false;                 // normals stored as two snorm components
+};
+
+void glInstanceAttribs();
+void glInstancedDraw(int vertexArray, int indexCount, unsigned int indexType, const mat4* models, int count, int shader, const MeshDecode* decode = nullptr);
+
+// per-frame globals uniform block (GlintGlobals)
+void glGlobalsInit(int screenWidth, int screenHeight);
+void glGlobalsSetCamera(const mat4& projection, const mat4& view);
+void glGlobalsSetCanvas(float width, float height);
+vec2 glGlobalsGetCanvas();
+void glGlobalsSetTime(float time);
+void glGlobalsSync();
+
+// texture cache: records a texture the library created; cached textures stay resident after release
+void glTextureRegister(int texture, int width, int height, size_t bytes, bool cached);
+
+// content version, changed by glTextureTouch whenever new pixels land in a texture; for caches derived from it.
+// 0 for GL names the cache does not track (render targets, raw glGenTextures ids), which can change unseen
+unsigned int glTextureGetVersion(int texture);
+void glTextureUploadPump();
+
+// render target pool: frees targets that have sat unused for a while, once per present
+void glRenderTargetPump();
+
+// gl state cache: every bind in the library goes through these so redundant calls can be skipped
+void glStateUseProgram(int program);
+void glStateBindVertexArray(int vertexArray);
+void glStateActiveTexture(int unit);
+void glStateBindTexture(int unit, int texture);
+void glStateForgetTexture(int texture);
+void glStateForgetVertexArray(int vertexArray);
+void glStateEnable(unsigned int capability, bool enabled);
+void glStateBlendFunc(unsigned int src, unsigned int dst);
+void glStateBindFramebuffer(int framebuffer);     // 0 binds the default framebuffer, which may be an FBO
+void glStateSetDefaultFramebuffer(int framebuffer);
+int glStateGetDefaultFramebuffer();
+void glStateViewport(int x, int y, int width, int height);
+
+int glStateGetProgram();
+int glStateGetActiveTexture();
+int glStateGetTexture(int unit);
+int glStateGetFramebuffer();
+bool glStateIsEnabled(unsigned int capability);
+void glStateGetViewport(int viewport[4]);
+
+void glStateEndFrame();
+
+// frame capture: glCapturePresent runs just before the swap, collecting finished readbacks and queueing new ones
+void glCaptureInit(int width, int height);
+void glCapturePresent();
+void glCaptureShutdown();     // waits for readbacks and encodes still in flight
+
+// dynamic resolution: Resolve upscales into the real framebuffer before the swap, Update picks the next scale after it
+void glResolutionInit(int width, int height);
+void glResolutionResolve();
+void glResolutionUpdate(double deltaTime);
+void glResolutionSuspend(bool suspended);   // while a title is paused the home screen draws at full size
+
+// headless backend: EGL context without a window, drawing into an FBO that stands in for the default framebuffer
+void* glHeadlessInit(int width, int height);
+void glHeadlessShutdown();
+void glHeadlessAttach();
+void glHeadlessPresent();
+bool glHeadlessRunning();
+double glHeadlessTime();
+void* glHeadlessContext();
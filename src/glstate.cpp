@@ -0,0 +1,275 @@
+#include "glint/glint.h"
+
+#include <glad/glad.h>
+
+#include "gl_internal.h"
+
+// texture units tracked by the cache; binds on higher units go straight to GL
+#define STATE_TEXTURE_UNITS 8
+
+// cached value that has not been observed since the last invalidate
+#define STATE_UNKNOWN -1
+
+struct GlStateCache {
+    int program;
+    int vertexArray;
+    int activeUnit;
+    int textures[STATE_TEXTURE_UNITS];
+    int blend;
+    int depthTest;
+    int blendSrc;
+    int blendDst;
+    int framebuffer;
+    int viewport[4];
+};
+
+static GlStateCache g_state;
+static int g_defaultFramebuffer = 0;
+static GlStateStats g_frameStats;
+static GlStateStats g_lastFrameStats;
+
+// returns true when the call has to reach GL, and records it either way
+static bool stateChange(int& cached, int value, GlStateCounter& counter)
+{
+    if (cached == value) {
+        counter.skipped++;
+        g_frameStats.skipped++;
+        return false;
+    }
+
+    cached = value;
+    counter.issued++;
+    g_frameStats.issued++;
+    return true;
+}
+
+void glStateInvalidate()
+{
+    g_state.program = STATE_UNKNOWN;
+    g_state.vertexArray = STATE_UNKNOWN;
+    g_state.activeUnit = STATE_UNKNOWN;
+    for (int i = 0; i < STATE_TEXTURE_UNITS; ++i) {
+        g_state.textures[i] = STATE_UNKNOWN;
+    }
+    g_state.blend = STATE_UNKNOWN;
+    g_state.depthTest = STATE_UNKNOWN;
+    g_state.blendSrc = STATE_UNKNOWN;
+    g_state.blendDst = STATE_UNKNOWN;
+    g_state.framebuffer = STATE_UNKNOWN;
+    for (int i = 0; i < 4; ++i) {
+        g_state.viewport[i] = STATE_UNKNOWN;
+    }
+}
+
+void glStateUseProgram(int program)
+{
+    if (stateChange(g_state.program, program, g_frameStats.program)) {
+        glUseProgram(program);
+    }
+}
+
+void glStateBindVertexArray(int vertexArray)
+{
+    if (stateChange(g_state.vertexArray, vertexArray, g_frameStats.vertexArray)) {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+void glStateActiveTexture(int unit)
+{
+    if (stateChange(g_state.activeUnit, unit, g_frameStats.texture)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+}
+
+void glStateBindTexture(int unit, int texture)
+{
+    if (unit < 0 || unit >= STATE_TEXTURE_UNITS) {
+        glStateActiveTexture(unit);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        return;
+    }
+
+    // the unit is left active even when the bind is skipped, callers may upload to the texture next
+    glStateActiveTexture(unit);
+    if (stateChange(g_state.textures[unit], texture, g_frameStats.texture)) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+    }
+}
+
+void glStateForgetTexture(int texture)
+{
+    // deleting a texture unbinds it from every unit of the current context
+    for (int i = 0; i < STATE_TEXTURE_UNITS; ++i) {
+        if (g_state.textures[i] == texture) {
+            g_state.textures[i] = 0;
+        }
+    }
+}
+
+void glStateForgetVertexArray(int vertexArray)
+{
+    // deleting the bound vertex array reverts the binding to zero
+    if (g_state.vertexArray == vertexArray) {
+        g_state.vertexArray = 0;
+    }
+}
+
+void glStateEnable(unsigned int capability, bool enabled)
+{
+    int* cached = nullptr;
+    if (capability == GL_BLEND) {
+        cached = &g_state.blend;
+    } else if (capability == GL_DEPTH_TEST) {
+        cached = &g_state.depthTest;
+    }
+
+    if (cached && !stateChange(*cached, enabled ? 1 : 0, g_frameStats.capability)) {
+        return;
+    }
+
+    if (enabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+}
+
+void glStateBlendFunc(unsigned int src, unsigned int dst)
+{
+    if (g_state.blendSrc == static_cast<int>(src) && g_state.blendDst == static_cast<int>(dst)) {
+        g_frameStats.blendFunc.skipped++;
+        g_frameStats.skipped++;
+        return;
+    }
+
+    g_state.blendSrc = static_cast<int>(src);
+    g_state.blendDst = static_cast<int>(dst);
+    g_frameStats.blendFunc.issued++;
+    g_frameStats.issued++;
+    glBlendFunc(src, dst);
+}
+
+void glStateSetDefaultFramebuffer(int framebuffer)
+{
+    g_defaultFramebuffer = framebuffer;
+}
+
+void glStateBindFramebuffer(int framebuffer)
+{
+    if (framebuffer == 0) {
+        framebuffer = g_defaultFramebuffer;
+    }
+
+    if (stateChange(g_state.framebuffer, framebuffer, g_frameStats.framebuffer)) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+}
+
+void glStateViewport(int x, int y, int width, int height)
+{
+    if (g_state.viewport[0] == x && g_state.viewport[1] == y &&
+        g_state.viewport[2] == width && g_state.viewport[3] == height) {
+        g_frameStats.viewport.skipped++;
+        g_frameStats.skipped++;
+        return;
+    }
+
+    g_state.viewport[0] = x;
+    g_state.viewport[1] = y;
+    g_state.viewport[2] = width;
+    g_state.viewport[3] = height;
+    g_frameStats.viewport.issued++;
+    g_frameStats.issued++;
+    glViewport(x, y, width, height);
+}
+
+// getters fall back to a GL query once after an invalidate, then answer from the cache
+
+int glStateGetProgram()
+{
+    if (g_state.program == STATE_UNKNOWN) {
+        glGetIntegerv(GL_CURRENT_PROGRAM, &g_state.program);
+    }
+    return g_state.program;
+}
+
+int glStateGetActiveTexture()
+{
+    if (g_state.activeUnit == STATE_UNKNOWN) {
+        GLint active = GL_TEXTURE0;
+        glGetIntegerv(GL_ACTIVE_TEXTURE, &active);
+        g_state.activeUnit = active - GL_TEXTURE0;
+    }
+    return g_state.activeUnit;
+}
+
+int glStateGetTexture(int unit)
+{
+    if (unit < 0 || unit >= STATE_TEXTURE_UNITS) {
+        return 0;
+    }
+
+    if (g_state.textures[unit] == STATE_UNKNOWN) {
+        glStateActiveTexture(unit);
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &g_state.textures[unit]);
+    }
+    return g_state.textures[unit];
+}
+
+bool glStateIsEnabled(unsigned int capability)
+{
+    int* cached = nullptr;
+    if (capability == GL_BLEND) {
+        cached = &g_state.blend;
+    } else if (capability == GL_DEPTH_TEST) {
+        cached = &g_state.depthTest;
+    }
+
+    if (!cached) {
+        return glIsEnabled(capability) == GL_TRUE;
+    }
+    if (*cached == STATE_UNKNOWN) {
+        *cached = glIsEnabled(capability) == GL_TRUE ? 1 : 0;
+    }
+    return *cached == 1;
+}
+
+int glStateGetDefaultFramebuffer()
+{
+    return g_defaultFramebuffer;
+}
+
+int glStateGetFramebuffer()
+{
+    if (g_state.framebuffer == STATE_UNKNOWN) {
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &g_state.framebuffer);
+    }
+    return g_state.framebuffer;
+}
+
+void glStateGetViewport(int viewport[4])
+{
+    if (g_state.viewport[2] == STATE_UNKNOWN) {
+        glGetIntegerv(GL_VIEWPORT, g_state.viewport);
+    }
+    for (int i = 0; i < 4; ++i) {
+        viewport[i] = g_state.viewport[i];
+    }
+}
+
+void glStateEndFrame()
+{
+    g_lastFrameStats = g_frameStats;
+    g_frameStats = GlStateStats();
+}
+
+GlStateStats glGetStateStats()
+{
+    return g_lastFrameStats;
+}
+
+void glTextureBind(int unit, int texture)
+{
+    glStateBindTexture(unit, texture);
+}
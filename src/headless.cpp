@@ -0,0 +1,252 @@
+#include "glint/glint.h"
+
+#include <glad/glad.h>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "gl_internal.h"
+
+#ifdef GLINT_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+// headless frames advance the clock by a fixed step, so runs are repeatable
+#define HEADLESS_FRAME_TIME (1.0 / 60.0)
+
+struct HeadlessContext {
+#ifdef GLINT_HAS_EGL
+    EGLDisplay display;
+    EGLContext context;
+    EGLSurface surface;         // EGL_NO_SURFACE when surfaceless contexts are supported
+#endif
+    unsigned int framebuffer;   // stands in for the window's default framebuffer
+    unsigned int colorBuffer;
+    unsigned int depthBuffer;
+    int width;
+    int height;
+};
+
+static bool g_headless = false;
+static HeadlessContext g_headlessContext;
+static int g_headlessFrame = 0;
+static int g_headlessFrameLimit = 0;        // GLINT_HEADLESS_FRAMES, 0 runs until the title stops
+static std::string g_headlessCapture;       // GLINT_HEADLESS_CAPTURE, the last frame is saved there
+
+bool glIsHeadless()
+{
+    return g_headless;
+}
+
+#ifdef GLINT_HAS_EGL
+
+static EGLDisplay headlessOpenDisplay()
+{
+    // Mesa's surfaceless platform needs neither a display server nor a GPU, llvmpipe renders on the cpu
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+            return display;
+        }
+    }
+
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+        return display;
+    }
+    return EGL_NO_DISPLAY;
+}
+
+static bool headlessCreateContext(HeadlessContext& headless)
+{
+    headless.display = headlessOpenDisplay();
+    if (headless.display == EGL_NO_DISPLAY) {
+        ioDebugPrint("Failed to open an EGL display for headless rendering\n");
+        return false;
+    }
+
+    ioDebugPrint("EGL vendor: %s, version: %s\n", eglQueryString(headless.display, EGL_VENDOR), eglQueryString(headless.display, EGL_VERSION));
+
+    if (!eglBindAPI(EGL_OPENGL_ES_API)) {
+        ioDebugPrint("EGL has no OpenGL ES support\n");
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT_KHR,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(headless.display, configAttribs, &config, 1, &configCount) || configCount == 0) {
+        ioDebugPrint("No EGL config with OpenGL ES 3.0 and pbuffer support\n");
+        return false;
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_CLIENT_VERSION, 3,
+        EGL_NONE
+    };
+
+    headless.context = eglCreateContext(headless.display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (headless.context == EGL_NO_CONTEXT) {
+        ioDebugPrint("Failed to create an OpenGL ES 3.0 context (EGL error 0x%x)\n", eglGetError());
+        return false;
+    }
+
+    // everything is drawn into an FBO; a 1x1 pbuffer only exists to make the context current
+    const char* extensions = eglQueryString(headless.display, EGL_EXTENSIONS);
+    headless.surface = EGL_NO_SURFACE;
+    if (!extensions || !std::strstr(extensions, "EGL_KHR_surfaceless_context")) {
+        const EGLint pbufferAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        headless.surface = eglCreatePbufferSurface(headless.display, config, pbufferAttribs);
+        if (headless.surface == EGL_NO_SURFACE) {
+            ioDebugPrint("Failed to create an EGL pbuffer (EGL error 0x%x)\n", eglGetError());
+            return false;
+        }
+    }
+
+    if (!eglMakeCurrent(headless.display, headless.surface, headless.surface, headless.context)) {
+        ioDebugPrint("Failed to make the headless context current (EGL error 0x%x)\n", eglGetError());
+        return false;
+    }
+
+    return true;
+}
+
+static bool headlessCreateFramebuffer(HeadlessContext& headless)
+{
+    glGenRenderbuffers(1, &headless.colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, headless.colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, headless.width, headless.height);
+
+    glGenRenderbuffers(1, &headless.depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, headless.depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, headless.width, headless.height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &headless.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, headless.framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, headless.colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, headless.depthBuffer);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        ioDebugPrint("Headless framebuffer incomplete: 0x%x\n", status);
+        return false;
+    }
+
+    // binding framebuffer 0 through the state cache now lands here
+    glStateSetDefaultFramebuffer(headless.framebuffer);
+    return true;
+}
+
+#endif
+
+void* glHeadlessInit(int width, int height)
+{
+#ifndef GLINT_HAS_EGL
+    (void)width;
+    (void)height;
+    ioDebugPrint("Headless rendering needs EGL, and glint was built without it\n");
+    return nullptr;
+#else
+    HeadlessContext& headless = g_headlessContext;
+    headless = HeadlessContext();
+    headless.width = width;
+    headless.height = height;
+
+    if (!headlessCreateContext(headless)) {
+        return nullptr;
+    }
+
+    // EGL 1.5 and Mesa hand out core entry points through eglGetProcAddress as well
+    if (!gladLoadGLES2Loader((GLADloadproc)eglGetProcAddress)) {
+        ioDebugPrint("Failed to initialize GLAD\n");
+        return nullptr;
+    }
+
+    if (!headlessCreateFramebuffer(headless)) {
+        return nullptr;
+    }
+
+    ioDebugPrint("Headless renderer: %s, %dx%d offscreen\n", (const char*)glGetString(GL_RENDERER), width, height);
+
+    const char* frames = std::getenv("GLINT_HEADLESS_FRAMES");
+    g_headlessFrameLimit = frames ? std::atoi(frames) : 0;
+    const char* capture = std::getenv("GLINT_HEADLESS_CAPTURE");
+    g_headlessCapture = capture ? capture : "";
+
+    g_headless = true;
+    g_headlessFrame = 0;
+    return &g_headlessContext;
+#endif
+}
+
+void glHeadlessShutdown()
+{
+    if (!g_headless) {
+        return;
+    }
+
+    if (!g_headlessCapture.empty()) {
+        glSaveFrame(g_headlessCapture.c_str());
+    }
+
+    HeadlessContext& headless = g_headlessContext;
+    glStateSetDefaultFramebuffer(0);
+    glStateBindFramebuffer(0);
+    glDeleteFramebuffers(1, &headless.framebuffer);
+    glDeleteRenderbuffers(1, &headless.colorBuffer);
+    glDeleteRenderbuffers(1, &headless.depthBuffer);
+
+#ifdef GLINT_HAS_EGL
+    eglMakeCurrent(headless.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (headless.surface != EGL_NO_SURFACE) {
+        eglDestroySurface(headless.display, headless.surface);
+    }
+    eglDestroyContext(headless.display, headless.context);
+    eglTerminate(headless.display);
+#endif
+
+    g_headless = false;
+}
+
+void glHeadlessAttach()
+{
+#ifdef GLINT_HAS_EGL
+    HeadlessContext& headless = g_headlessContext;
+    if (!eglMakeCurrent(headless.display, headless.surface, headless.surface, headless.context)) {
+        ioDebugPrint("Failed to make the headless context current (EGL error 0x%x)\n", eglGetError());
+    }
+#endif
+}
+
+void glHeadlessPresent()
+{
+    g_headlessFrame++;
+}
+
+bool glHeadlessRunning()
+{
+    return g_headlessFrameLimit <= 0 || g_headlessFrame < g_headlessFrameLimit;
+}
+
+double glHeadlessTime()
+{
+    return g_headlessFrame * HEADLESS_FRAME_TIME;
+}
+
+void* glHeadlessContext()
+{
+    return g_headless ? &g_headlessContext : nullptr;
+}
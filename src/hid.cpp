@@ -14,13 +14,17 @@ void hidInit() {
 
 void hidFlush()
 {
+    if (glIsHeadless()) {
+        return; // no window, no events
+    }
+
     glfwPollEvents();
 }
 
 void hidRefreshButtonState(int button)
 {
-    if (glGetContext() == nullptr) {
-        return; // No context, cannot refresh button state
+    if (glGetContext() == nullptr || glIsHeadless()) {
+        return; // No window, cannot refresh button state
     }
 
     buttonState[button] = glfwGetKey((GLFWwindow*)glGetContext(), button);
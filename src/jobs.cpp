@@ -0,0 +1,78 @@
+#include "glint/glint.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "jobs_internal.h"
+
+struct JobPool {
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> queue;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    ~JobPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            queue.clear();
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+};
+
+static JobPool g_jobs;
+
+static void jobsWorker()
+{
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(g_jobs.mutex);
+            g_jobs.wake.wait(lock, [] { return g_jobs.stopping || !g_jobs.queue.empty(); });
+            if (g_jobs.stopping) {
+                return;
+            }
+            job = std::move(g_jobs.queue.front());
+            g_jobs.queue.pop_front();
+        }
+        job();
+    }
+}
+
+// workers are started on first use; one core is left for the GL thread
+static void jobsStart()
+{
+    int count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    for (int i = 0; i < count; ++i) {
+        g_jobs.workers.emplace_back(jobsWorker);
+    }
+    ioDebugPrint("Job pool started with %d workers\n", count);
+}
+
+void jobsSubmit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(g_jobs.mutex);
+        if (g_jobs.workers.empty()) {
+            jobsStart();
+        }
+        g_jobs.queue.push_back(std::move(job));
+    }
+    g_jobs.wake.notify_one();
+}
+
+int jobsWorkerCount()
+{
+    std::lock_guard<std::mutex> lock(g_jobs.mutex);
+    return static_cast<int>(g_jobs.workers.size());
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include <functional>
+
+// small worker pool for cpu-side work (image decoding, ...).
+// jobs run on other threads, so they must not call into GL.
+void jobsSubmit(std::function<void()> job);
+int jobsWorkerCount();
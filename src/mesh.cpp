@@ -0,0 +1,333 @@
+#include "glint/glint.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gl_internal.h"
+
+// .gmesh file, written by glt_execcreate (little endian):
+//   MeshFileHeader
+//   attributeCount x MeshFileAttribute
+//   vertex data, vertexCount * vertexStride bytes, starting at a 4 byte aligned offset
+//   index data, indexCount * indexSize bytes, starting at a 4 byte aligned offset
+struct MeshFileHeader {
+    char magic[4];          // "GMSH"
+    uint16_t version;
+    uint16_t attributeCount;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint16_t vertexStride;
+    uint16_t indexSize;     // 2 or 4
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+struct MeshFileAttribute {
+    uint8_t location;
+    uint8_t components;
+    uint8_t normalized;
+    uint8_t reserved;
+    uint16_t type;          // GL component type, e.g. GL_FLOAT or GL_HALF_FLOAT
+    uint16_t offset;
+};
+
+#define MESH_FILE_VERSION 1
+
+struct MeshEntry {
+    unsigned int vertexBuffer;
+    unsigned int indexBuffer;
+    int indexCount;
+    unsigned int indexType;
+    vec3 boundsMin;
+    vec3 boundsMax;
+    MeshDecode decode;
+    int refCount;
+    std::string path;       // empty for meshes built with glMeshCreate
+};
+
+// keyed by the VAO name, which doubles as the mesh handle
+static std::unordered_map<int, MeshEntry> g_meshes;
+static std::unordered_map<std::string, int> g_meshPaths;
+
+static size_t meshAlign(size_t offset)
+{
+    return (offset + 3) & ~static_cast<size_t>(3);
+}
+
+static int meshUpload(const GlMeshAttribute* attributes, int attributeCount, int stride, const void* vertices, int vertexCount, const void* indices, int indexCount, int indexSize)
+{
+    MeshEntry entry = MeshEntry();
+    unsigned int vertexArray = 0;
+    glGenVertexArrays(1, &vertexArray);
+    glGenBuffers(1, &entry.vertexBuffer);
+    glGenBuffers(1, &entry.indexBuffer);
+
+    // the VAO records the index buffer and the attribute layout, so a draw is a single bind
+    glStateBindVertexArray(vertexArray);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, entry.indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<size_t>(indexCount) * indexSize, indices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, entry.vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<size_t>(vertexCount) * stride, vertices, GL_STATIC_DRAW);
+
+    for (int i = 0; i < attributeCount; ++i) {
+        const GlMeshAttribute& attribute = attributes[i];
+        glEnableVertexAttribArray(attribute.location);
+        glVertexAttribPointer(attribute.location, attribute.components, attribute.type,
+                              attribute.normalized ? GL_TRUE : GL_FALSE, stride, (void*)(uintptr_t)attribute.offset);
+    }
+
+    glInstanceAttribs();
+
+    glStateBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    entry.indexCount = indexCount;
+    entry.indexType = (indexSize == 2) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    entry.refCount = 1;
+    g_meshes[vertexArray] = entry;
+    return vertexArray;
+}
+
+// bytes one component takes in the vertex, 0 for types glVertexAttribPointer does not accept
+static int meshComponentSize(unsigned int type)
+{
+    switch (type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:
+            return 2;
+        case GL_INT:
+        case GL_UNSIGNED_INT:
+        case GL_FIXED:
+        case GL_FLOAT:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+static bool meshValidate(const GlMeshAttribute* attributes, int attributeCount, int stride, int vertexCount, int indexCount, int indexSize)
+{
+    if (vertexCount <= 0 || indexCount <= 0 || stride <= 0 || (indexSize != 2 && indexSize != 4)) {
+        return false;
+    }
+
+    for (int i = 0; i < attributeCount; ++i) {
+        const GlMeshAttribute& attribute = attributes[i];
+        // 3-9 are fed from the instance buffer
+        if (attribute.location < 0 || (attribute.location >= 3 && attribute.location <= 9) ||
+            attribute.components < 1 || attribute.components > 4 || attribute.offset < 0) {
+            return false;
+        }
+
+        // packed 10-10-10-2 attributes are four components in one 32-bit word
+        bool packed = attribute.type == GL_INT_2_10_10_10_REV || attribute.type == GL_UNSIGNED_INT_2_10_10_10_REV;
+        int size = packed ? (attribute.components == 4 ? 4 : 0) : attribute.components * meshComponentSize(attribute.type);
+        if (size == 0 || attribute.offset + size > stride) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// GLES 3.0 makes no promise about fetches past the vertex buffer, so an index that points there is rejected up front
+static bool meshIndicesInRange(const void* indices, int indexCount, int indexSize, int vertexCount)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(indices);
+    uint32_t largest = 0;
+    for (int i = 0; i < indexCount; ++i) {
+        uint32_t index;
+        if (indexSize == 2) {
+            uint16_t shortIndex;
+            std::memcpy(&shortIndex, bytes + i * 2, sizeof(shortIndex));
+            index = shortIndex;
+        } else {
+            std::memcpy(&index, bytes + i * 4, sizeof(index));
+        }
+        largest = std::max(largest, index);
+    }
+    return largest < static_cast<uint32_t>(vertexCount);
+}
+
+int glMeshCreate(const GlMeshAttribute* attributes, int attributeCount, int stride, const void* vertices, int vertexCount, const void* indices, int indexCount, int indexSize)
+{
+    if (!attributes || !vertices || !indices || !meshValidate(attributes, attributeCount, stride, vertexCount, indexCount, indexSize)) {
+        ioDebugPrint("Invalid mesh description\n");
+        return 0;
+    }
+
+    if (!meshIndicesInRange(indices, indexCount, indexSize, vertexCount)) {
+        ioDebugPrint("Mesh index out of range of its %d vertices\n", vertexCount);
+        return 0;
+    }
+
+    int mesh = meshUpload(attributes, attributeCount, stride, vertices, vertexCount, indices, indexCount, indexSize);
+
+    // bounds from the position attribute when it is plain floats
+    MeshEntry& entry = g_meshes[mesh];
+    for (int i = 0; i < attributeCount; ++i) {
+        if (attributes[i].location != 0 || attributes[i].type != GL_FLOAT || attributes[i].components < 3) {
+            continue;
+        }
+
+        const unsigned char* vertex = static_cast<const unsigned char*>(vertices) + attributes[i].offset;
+        for (int v = 0; v < vertexCount; ++v, vertex += stride) {
+            float position[3];
+            std::memcpy(position, vertex, sizeof(position));
+            vec3 point(position[0], position[1], position[2]);
+            if (v == 0) {
+                entry.boundsMin = point;
+                entry.boundsMax = point;
+            }
+            entry.boundsMin = vec3(std::min(entry.boundsMin.x, point.x), std::min(entry.boundsMin.y, point.y), std::min(entry.boundsMin.z, point.z));
+            entry.boundsMax = vec3(std::max(entry.boundsMax.x, point.x), std::max(entry.boundsMax.y, point.y), std::max(entry.boundsMax.z, point.z));
+        }
+        break;
+    }
+
+    return mesh;
+}
+
+int glMeshLoad(const char* path)
+{
+    if (!path) {
+        return 0;
+    }
+
+    auto pathIt = g_meshPaths.find(path);
+    if (pathIt != g_meshPaths.end()) {
+        g_meshes[pathIt->second].refCount++;
+        return pathIt->second;
+    }
+
+    // resource paths point straight into the mounted pack, so the buffers are filled without a copy
+    bool isResource = path[0] && path[1] == ':' && path[2] == '/';
+
+    size_t size = 0;
+    const unsigned char* data = static_cast<const unsigned char*>(fsReadFile(path, &size));
+    if (!data) {
+        ioDebugPrint("Failed to read mesh: %s\n", path);
+        return 0;
+    }
+
+    int mesh = 0;
+    MeshFileHeader header;
+    if (size < sizeof(header)) {
+        ioDebugPrint("Mesh file too small: %s\n", path);
+    } else {
+        std::memcpy(&header, data, sizeof(header));
+
+        size_t attributesOffset = sizeof(header);
+        size_t verticesOffset = meshAlign(attributesOffset + header.attributeCount * sizeof(MeshFileAttribute));
+        size_t indicesOffset = meshAlign(verticesOffset + static_cast<size_t>(header.vertexCount) * header.vertexStride);
+        size_t end = indicesOffset + static_cast<size_t>(header.indexCount) * header.indexSize;
+
+        if (std::memcmp(header.magic, "GMSH", 4) != 0 || header.version != MESH_FILE_VERSION) {
+            ioDebugPrint("Invalid mesh format: %s\n", path);
+        } else if (end > size) {
+            ioDebugPrint("Mesh file truncated: %s\n", path);
+        } else {
+            std::vector<GlMeshAttribute> attributes(header.attributeCount);
+            for (int i = 0; i < header.attributeCount; ++i) {
+                MeshFileAttribute fileAttribute;
+                std::memcpy(&fileAttribute, data + attributesOffset + i * sizeof(fileAttribute), sizeof(fileAttribute));
+                attributes[i].location = fileAttribute.location;
+                attributes[i].components = fileAttribute.components;
+                attributes[i].type = fileAttribute.type;
+                attributes[i].normalized = fileAttribute.normalized != 0;
+                attributes[i].offset = fileAttribute.offset;
+            }
+
+            if (!meshValidate(attributes.data(), header.attributeCount, header.vertexStride, header.vertexCount, header.indexCount, header.indexSize)) {
+                ioDebugPrint("Invalid mesh layout: %s\n", path);
+            } else if (!meshIndicesInRange(data + indicesOffset, header.indexCount, header.indexSize, header.vertexCount)) {
+                ioDebugPrint("Mesh index out of range: %s\n", path);
+            } else {
+                mesh = meshUpload(attributes.data(), header.attributeCount, header.vertexStride,
+                                  data + verticesOffset, header.vertexCount,
+                                  data + indicesOffset, header.indexCount, header.indexSize);
+
+                MeshEntry& entry = g_meshes[mesh];
+                entry.boundsMin = vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+                entry.boundsMax = vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+                entry.path = path;
+                g_meshPaths[path] = mesh;
+
+                // snorm16 positions are relative to the bounds, octahedral normals have two components
+                for (const GlMeshAttribute& attribute : attributes) {
+                    if (attribute.location == 0 && attribute.type == GL_SHORT && attribute.normalized) {
+                        vec3 extent = (entry.boundsMax - entry.boundsMin) * 0.5f;
+                        entry.decode.positionScale = vec3(extent.x > 0.0f ? extent.x : 1.0f, extent.y > 0.0f ? extent.y : 1.0f, extent.z > 0.0f ? extent.z : 1.0f);
+                        entry.decode.positionOffset = (entry.boundsMax + entry.boundsMin) * 0.5f;
+                    } else if (attribute.location == 1 && attribute.components == 2) {
+                        entry.decode.octahedralNormals = true;
+                    }
+                }
+
+                ioDebugPrint("Loaded mesh %s: %u vertices, %u indices\n", path, header.vertexCount, header.indexCount);
+            }
+        }
+    }
+
+    if (!isResource) {
+        delete[] reinterpret_cast<const char*>(data);
+    }
+    return mesh;
+}
+
+void glMeshRelease(int mesh)
+{
+    auto it = g_meshes.find(mesh);
+    if (it == g_meshes.end() || --it->second.refCount > 0) {
+        return;
+    }
+
+    MeshEntry& entry = it->second;
+    if (!entry.path.empty()) {
+        g_meshPaths.erase(entry.path);
+    }
+
+    unsigned int vertexArray = mesh;
+    glDeleteVertexArrays(1, &vertexArray);
+    glStateForgetVertexArray(mesh);
+    glDeleteBuffers(1, &entry.vertexBuffer);
+    glDeleteBuffers(1, &entry.indexBuffer);
+    g_meshes.erase(it);
+}
+
+void glMeshDraw(int mesh, mat4 model, int shader)
+{
+    glMeshDrawInstanced(mesh, &model, 1, shader);
+}
+
+void glMeshDrawInstanced(int mesh, const mat4* models, int count, int shader)
+{
+    auto it = g_meshes.find(mesh);
+    if (it == g_meshes.end()) {
+        return;
+    }
+
+    glInstancedDraw(mesh, it->second.indexCount, it->second.indexType, models, count, shader, &it->second.decode);
+}
+
+bool glMeshGetBounds(int mesh, vec3* boundsMin, vec3* boundsMax)
+{
+    auto it = g_meshes.find(mesh);
+    if (it == g_meshes.end()) {
+        return false;
+    }
+
+    if (boundsMin) *boundsMin = it->second.boundsMin;
+    if (boundsMax) *boundsMax = it->second.boundsMax;
+    return true;
+}
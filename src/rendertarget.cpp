@@ -0,0 +1,157 @@
+#include "glint/glint.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <vector>
+
+#include "gl_internal.h"
+
+// presents a released target may sit unused before its memory is given back
+#define RENDER_TARGET_IDLE_FRAMES 120
+
+struct PooledTarget {
+    GlRenderTarget target;
+    unsigned int format;
+    size_t bytes;
+    bool inUse;
+    int idleFrames;
+};
+
+// a handful of entries at most, so a linear search by size and format is all the keying needed
+static std::vector<PooledTarget> g_renderTargets;
+static GlRenderTargetStats g_renderTargetStats;
+
+static bool renderTargetFormat(unsigned int internalFormat, GLenum* format, GLenum* type, int* pixelBytes)
+{
+    switch (internalFormat) {
+    case GL_RGBA8:
+        *format = GL_RGBA; *type = GL_UNSIGNED_BYTE; *pixelBytes = 4;
+        return true;
+    case GL_RGB8:
+        *format = GL_RGB; *type = GL_UNSIGNED_BYTE; *pixelBytes = 3;
+        return true;
+    case GL_R8:
+        *format = GL_RED; *type = GL_UNSIGNED_BYTE; *pixelBytes = 1;
+        return true;
+    case GL_RGBA16F:
+        *format = GL_RGBA; *type = GL_HALF_FLOAT; *pixelBytes = 8;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void renderTargetDelete(PooledTarget& pooled)
+{
+    if (glStateGetFramebuffer() == pooled.target.framebuffer) {
+        glStateBindFramebuffer(0);
+    }
+
+    unsigned int framebuffer = pooled.target.framebuffer;
+    unsigned int texture = pooled.target.texture;
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteTextures(1, &texture);
+    glStateForgetTexture(pooled.target.texture);
+
+    g_renderTargetStats.targets--;
+    g_renderTargetStats.bytes -= pooled.bytes;
+}
+
+GlRenderTarget glRenderTargetAcquire(int width, int height, unsigned int internalFormat)
+{
+    GLenum format, type;
+    int pixelBytes;
+    if (width <= 0 || height <= 0 || !renderTargetFormat(internalFormat, &format, &type, &pixelBytes)) {
+        ioDebugPrint("Invalid render target %dx%d (format 0x%x)\n", width, height, internalFormat);
+        return GlRenderTarget();
+    }
+
+    for (PooledTarget& pooled : g_renderTargets) {
+        if (!pooled.inUse && pooled.target.width == width && pooled.target.height == height && pooled.format == internalFormat) {
+            pooled.inUse = true;
+            pooled.idleFrames = 0;
+            g_renderTargetStats.inUse++;
+            g_renderTargetStats.reused++;
+            return pooled.target;
+        }
+    }
+
+    PooledTarget pooled;
+    pooled.format = internalFormat;
+    pooled.bytes = static_cast<size_t>(width) * height * pixelBytes;
+    pooled.inUse = true;
+    pooled.idleFrames = 0;
+    pooled.target.width = width;
+    pooled.target.height = height;
+
+    unsigned int texture = 0;
+    glGenTextures(1, &texture);
+    glStateBindTexture(0, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    pooled.target.texture = texture;
+
+    unsigned int framebuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    int prevFramebuffer = glStateGetFramebuffer();
+    glStateBindFramebuffer(framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    glStateBindFramebuffer(prevFramebuffer);
+    pooled.target.framebuffer = framebuffer;
+
+    g_renderTargets.push_back(pooled);
+    g_renderTargetStats.targets++;
+    g_renderTargetStats.inUse++;
+    g_renderTargetStats.created++;
+    g_renderTargetStats.bytes += pooled.bytes;
+    g_renderTargetStats.peakBytes = std::max(g_renderTargetStats.peakBytes, g_renderTargetStats.bytes);
+    return pooled.target;
+}
+
+void glRenderTargetRelease(const GlRenderTarget& target)
+{
+    for (PooledTarget& pooled : g_renderTargets) {
+        if (pooled.target.framebuffer == target.framebuffer && pooled.inUse) {
+            // draws already issued from it stay ordered before whatever the next borrower renders
+            pooled.inUse = false;
+            pooled.idleFrames = 0;
+            g_renderTargetStats.inUse--;
+            return;
+        }
+    }
+}
+
+void glRenderTargetPump()
+{
+    for (size_t i = 0; i < g_renderTargets.size();) {
+        PooledTarget& pooled = g_renderTargets[i];
+        if (!pooled.inUse && ++pooled.idleFrames > RENDER_TARGET_IDLE_FRAMES) {
+            renderTargetDelete(pooled);
+            g_renderTargets[i] = g_renderTargets.back();
+            g_renderTargets.pop_back();
+            continue;
+        }
+        ++i;
+    }
+}
+
+void glRenderTargetTrim()
+{
+    for (size_t i = 0; i < g_renderTargets.size();) {
+        if (!g_renderTargets[i].inUse) {
+            renderTargetDelete(g_renderTargets[i]);
+            g_renderTargets[i] = g_renderTargets.back();
+            g_renderTargets.pop_back();
+            continue;
+        }
+        ++i;
+    }
+}
+
+GlRenderTargetStats glGetRenderTargetStats()
+{
+    return g_renderTargetStats;
+}
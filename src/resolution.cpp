@@ -0,0 +1,231 @@
+#include "glint/glint.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+
+#include "gl_internal.h"
+
+// frames averaged before the scale is reconsidered; the window restarts after every change
+#define RESOLUTION_WINDOW 30
+
+// scales are multiples of this, so the render size does not creep by a pixel every few frames
+#define RESOLUTION_STEP 0.05f
+
+// the average may run this far over the target frame time before the scale drops
+#define RESOLUTION_SLACK 1.1f
+
+struct ResolutionState {
+    bool enabled = false;
+    bool suspended = false;
+    GlDynamicResolution settings;
+
+    unsigned int framebuffer = 0;
+    unsigned int colorBuffer = 0;
+    unsigned int depthBuffer = 0;
+    int outputFramebuffer = 0;      // what framebuffer 0 meant before, the window or the headless target
+
+    int screenWidth = 0;
+    int screenHeight = 0;
+    float scale = 1.0f;
+    int width = 0;                  // the part of the target rendered this frame
+    int height = 0;
+
+    double frameTimes[RESOLUTION_WINDOW] = {};
+    int frameCount = 0;
+};
+
+static ResolutionState g_resolution;
+
+static void resolutionApply()
+{
+    ResolutionState& res = g_resolution;
+    res.width = std::max(1, static_cast<int>(std::lround(res.screenWidth * res.scale)));
+    res.height = std::max(1, static_cast<int>(std::lround(res.screenHeight * res.scale)));
+
+    // titles draw to framebuffer 0 as usual and land in the lower left corner of the scaled target
+    glStateSetDefaultFramebuffer(res.framebuffer);
+    glStateBindFramebuffer(0);
+    glStateViewport(0, 0, res.width, res.height);
+}
+
+static void resolutionRestore()
+{
+    glStateSetDefaultFramebuffer(g_resolution.outputFramebuffer);
+    glStateBindFramebuffer(0);
+    glStateViewport(0, 0, g_resolution.screenWidth, g_resolution.screenHeight);
+}
+
+static float resolutionQuantize(float scale)
+{
+    const GlDynamicResolution& settings = g_resolution.settings;
+    scale = std::round(scale / RESOLUTION_STEP) * RESOLUTION_STEP;
+    return std::min(std::max(scale, settings.minScale), settings.maxScale);
+}
+
+void glResolutionInit(int width, int height)
+{
+    g_resolution.screenWidth = width;
+    g_resolution.screenHeight = height;
+}
+
+void glResolutionResolve()
+{
+    ResolutionState& res = g_resolution;
+    if (!res.enabled || res.suspended) {
+        return;
+    }
+
+    // upscale into the real framebuffer, which stays bound as framebuffer 0 until glResolutionUpdate so
+    // anything reading the presented frame (captures) sees the full size image
+    glStateSetDefaultFramebuffer(res.outputFramebuffer);
+    glStateBindFramebuffer(0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, res.framebuffer);
+    glBlitFramebuffer(0, 0, res.width, res.height, 0, 0, res.screenWidth, res.screenHeight,
+                      GL_COLOR_BUFFER_BIT, (res.width == res.screenWidth && res.height == res.screenHeight) ? GL_NEAREST : GL_LINEAR);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, res.outputFramebuffer);
+    glStateViewport(0, 0, res.screenWidth, res.screenHeight);
+}
+
+void glResolutionUpdate(double deltaTime)
+{
+    ResolutionState& res = g_resolution;
+    if (!res.enabled || res.suspended) {
+        return;
+    }
+
+    res.frameTimes[res.frameCount % RESOLUTION_WINDOW] = deltaTime;
+    res.frameCount++;
+
+    if (res.frameCount >= RESOLUTION_WINDOW) {
+        double average = 0.0;
+        for (double frameTime : res.frameTimes) {
+            average += frameTime;
+        }
+        average /= RESOLUTION_WINDOW;
+
+        double target = 1.0 / res.settings.targetFps;
+        float scale = res.scale;
+        if (average > target * RESOLUTION_SLACK) {
+            // fill cost follows the pixel count, which goes with the square of the scale
+            scale = std::min(resolutionQuantize(res.scale * static_cast<float>(std::sqrt(target / average))), res.scale - RESOLUTION_STEP);
+        } else if (average <= target * 1.02) {
+            // at the target with vsync there is no telling how much headroom is left, so creep back up
+            scale = res.scale + RESOLUTION_STEP;
+        }
+
+        scale = resolutionQuantize(scale);
+        if (scale != res.scale) {
+            res.scale = scale;
+            res.frameCount = 0;
+        }
+    }
+
+    resolutionApply();
+}
+
+void glResolutionSuspend(bool suspended)
+{
+    ResolutionState& res = g_resolution;
+    if (!res.enabled || res.suspended == suspended) {
+        return;
+    }
+
+    res.suspended = suspended;
+    res.frameCount = 0;
+    if (suspended) {
+        resolutionRestore();
+    } else {
+        resolutionApply();
+    }
+}
+
+bool glDynamicResolutionEnable(const GlDynamicResolution& settings)
+{
+    ResolutionState& res = g_resolution;
+    if (!GLAD_GL_ES_VERSION_3_0) {
+        ioDebugPrint("Dynamic resolution needs OpenGL ES 3.0 (glBlitFramebuffer)\n");
+        return false;
+    }
+
+    if (settings.minScale <= 0.0f || settings.minScale > settings.maxScale || settings.maxScale > 1.0f || settings.targetFps <= 0.0f) {
+        ioDebugPrint("Invalid dynamic resolution settings\n");
+        return false;
+    }
+
+    if (res.enabled) {
+        glDynamicResolutionDisable();
+    }
+
+    res.settings = settings;
+    res.outputFramebuffer = glStateGetDefaultFramebuffer();
+
+    // sized for the largest scale; smaller scales render into a corner, so changing scale never reallocates
+    int width = std::max(1, static_cast<int>(std::lround(res.screenWidth * settings.maxScale)));
+    int height = std::max(1, static_cast<int>(std::lround(res.screenHeight * settings.maxScale)));
+
+    glGenRenderbuffers(1, &res.colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, res.colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &res.depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, res.depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &res.framebuffer);
+    glStateBindFramebuffer(res.framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, res.colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, res.depthBuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        ioDebugPrint("Dynamic resolution target incomplete\n");
+        glStateBindFramebuffer(0);
+        glDeleteFramebuffers(1, &res.framebuffer);
+        glDeleteRenderbuffers(1, &res.colorBuffer);
+        glDeleteRenderbuffers(1, &res.depthBuffer);
+        res.framebuffer = res.colorBuffer = res.depthBuffer = 0;
+        return false;
+    }
+
+    res.enabled = true;
+    res.suspended = false;
+    res.scale = settings.maxScale;
+    res.frameCount = 0;
+    resolutionApply();
+
+    ioDebugPrint("Dynamic resolution on: %.2f-%.2f scale, %.0f fps target\n", settings.minScale, settings.maxScale, settings.targetFps);
+    return true;
+}
+
+void glDynamicResolutionDisable()
+{
+    ResolutionState& res = g_resolution;
+    if (!res.enabled) {
+        return;
+    }
+
+    resolutionRestore();
+    glDeleteFramebuffers(1, &res.framebuffer);
+    glDeleteRenderbuffers(1, &res.colorBuffer);
+    glDeleteRenderbuffers(1, &res.depthBuffer);
+    res.framebuffer = res.colorBuffer = res.depthBuffer = 0;
+
+    res.enabled = false;
+    res.suspended = false;
+    res.scale = 1.0f;
+}
+
+float glGetRenderScale()
+{
+    const ResolutionState& res = g_resolution;
+    return (res.enabled && !res.suspended) ? res.scale : 1.0f;
+}
+
+void glGetRenderSize(int* width, int* height)
+{
+    const ResolutionState& res = g_resolution;
+    bool scaled = res.enabled && !res.suspended;
+    if (width) *width = scaled ? res.width : res.screenWidth;
+    if (height) *height = scaled ? res.height : res.screenHeight;
+}
@@ -0,0 +1,389 @@
+#include "glint/glint.h"
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gl_internal.h"
+
+// binding point of the GlintGlobals uniform block
+#define GLOBALS_BINDING 0
+
+// declarations injected after the #version line of every ES 3 shader
+static const char* g_shaderPrelude = R"(
+layout(std140) uniform GlintGlobals {
+    highp mat4 glintProjection;
+    highp mat4 glintView;
+    highp vec4 glintScreenSize; // xy = size in pixels, zw = 1 / size
+    highp vec4 glintCanvas;     // xy = size of the 2D coordinate space, zw = 1 / size
+    highp float glintTime;
+};
+
+// 2D position (origin top left, y down) to clip space; the canvas is stretched over the viewport
+highp vec4 glintCanvasToClip(highp vec2 position) {
+    highp vec2 ndc = position * glintCanvas.zw * 2.0 - 1.0;
+    return vec4(ndc.x, -ndc.y, 0.0, 1.0);
+}
+)";
+
+struct ShaderUniform {
+    int location;
+    unsigned int type;
+    float value[16];    // last uploaded value, used to skip redundant uploads
+    bool hasValue;
+};
+
+struct ShaderProgram {
+    std::vector<ShaderUniform> uniforms;
+    std::unordered_map<std::string, int> slots;
+    int builtin[SHADER_SLOT_COUNT];
+};
+
+// std140 layout of GlintGlobals
+struct GlobalsBlock {
+    float projection[16];
+    float view[16];
+    float screenSize[4];
+    float canvas[4];
+    float time;
+    float pad[3];
+};
+
+static const char* g_builtinNames[SHADER_SLOT_COUNT] = {
+    "position",
+    "scale",
+    "alphaValue",
+    "color",
+    "tex",
+    "model",
+    "view",
+    "projection",
+    "octahedralNormals",
+    "positionScale",
+    "positionOffset",
+};
+
+// indexed by GL program name, which the driver hands out as small integers
+static std::vector<ShaderProgram*> g_programs;
+
+static unsigned int g_globalsUBO = 0;
+static GlobalsBlock g_globals;
+static bool g_globalsDirty = true;
+
+static ShaderProgram* shaderGetProgram(int shader)
+{
+    if (shader <= 0 || shader >= static_cast<int>(g_programs.size())) {
+        return nullptr;
+    }
+    return g_programs[shader];
+}
+
+static std::string shaderInjectPrelude(const char* src)
+{
+    std::string source(src);
+
+    size_t versionPos = source.find("#version");
+    if (versionPos == std::string::npos || source.compare(versionPos, 12, "#version 300") < 0) {
+        return source; // uniform blocks need ES 3
+    }
+
+    size_t lineEnd = source.find('\n', versionPos);
+    if (lineEnd == std::string::npos) {
+        return source;
+    }
+
+    // keep compiler line numbers matching the caller's source
+    int line = 1;
+    for (size_t i = 0; i <= lineEnd; ++i) {
+        if (source[i] == '\n') line++;
+    }
+
+    std::string prelude = g_shaderPrelude;
+    prelude += "#line " + std::to_string(line) + "\n";
+    source.insert(lineEnd + 1, prelude);
+    return source;
+}
+
+static void shaderReflect(unsigned int program)
+{
+    ShaderProgram* reflected = new ShaderProgram();
+
+    int uniformCount = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+
+    for (int i = 0; i < uniformCount; ++i) {
+        char name[128];
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, i, sizeof(name), &length, &size, &type, name);
+
+        int location = glGetUniformLocation(program, name);
+        if (location < 0) {
+            continue; // member of a uniform block
+        }
+
+        ShaderUniform uniform;
+        uniform.location = location;
+        uniform.type = type;
+        uniform.hasValue = false;
+
+        int slot = static_cast<int>(reflected->uniforms.size());
+        reflected->uniforms.push_back(uniform);
+        reflected->slots[name] = slot;
+
+        // arrays are reported as "name[0]"; also expose them by their plain name
+        if (length > 3 && std::strcmp(name + length - 3, "[0]") == 0) {
+            reflected->slots[std::string(name, length - 3)] = slot;
+        }
+    }
+
+    for (int i = 0; i < SHADER_SLOT_COUNT; ++i) {
+        auto it = reflected->slots.find(g_builtinNames[i]);
+        reflected->builtin[i] = (it != reflected->slots.end()) ? it->second : -1;
+    }
+
+    unsigned int blockIndex = glGetUniformBlockIndex(program, "GlintGlobals");
+    if (blockIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program, blockIndex, GLOBALS_BINDING);
+    }
+
+    if (program >= g_programs.size()) {
+        g_programs.resize(program + 1, nullptr);
+    }
+    delete g_programs[program];
+    g_programs[program] = reflected;
+}
+
+int glGenerateShader(const char *vertexSrc, const char *fragmentSrc)
+{
+    std::string vertexSource = shaderInjectPrelude(vertexSrc);
+    std::string fragmentSource = shaderInjectPrelude(fragmentSrc);
+    const char* vertexPtr = vertexSource.c_str();
+    const char* fragmentPtr = fragmentSource.c_str();
+
+    unsigned int cached = glShaderCacheLoad(vertexSource, fragmentSource);
+    if (cached) {
+        shaderReflect(cached);
+        return cached;
+    }
+
+    auto compileStart = std::chrono::steady_clock::now();
+
+    unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex, 1, &vertexPtr, nullptr);
+    glCompileShader(vertex);
+
+    int success;
+    char infoLog[512];
+    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(vertex, 512, nullptr, infoLog);
+        ioDebugPrint("Vertex shader compilation failed: %s\n", infoLog);
+        glDeleteShader(vertex);
+        return 0;
+    }
+
+    unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragment, 1, &fragmentPtr, nullptr);
+    glCompileShader(fragment);
+
+    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(fragment, 512, nullptr, infoLog);
+        ioDebugPrint("Fragment shader compilation failed: %s\n", infoLog);
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        return 0;
+    }
+
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    if (GLAD_GL_ES_VERSION_3_0) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(program);
+
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        ioDebugPrint("Shader program linking failed: %s\n", infoLog);
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+
+    double compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count();
+    glShaderCacheStore(program, vertexSource, fragmentSource, compileMs);
+
+    shaderReflect(program);
+
+    return program;
+}
+
+int glShaderGetUniform(int shader, const char *name)
+{
+    ShaderProgram* program = shaderGetProgram(shader);
+    if (!program || !name) {
+        return -1;
+    }
+
+    auto it = program->slots.find(name);
+    return (it != program->slots.end()) ? it->second : -1;
+}
+
+int glShaderBuiltinSlot(int shader, ShaderSlot slot)
+{
+    ShaderProgram* program = shaderGetProgram(shader);
+    return program ? program->builtin[slot] : -1;
+}
+
+void glShaderUse(int shader)
+{
+    glStateUseProgram(shader);
+}
+
+// returns the uniform to upload to, or nullptr when the value is unchanged
+static ShaderUniform* shaderPrepareSet(int shader, int slot, const float* value, int count)
+{
+    ShaderProgram* program = shaderGetProgram(shader);
+    if (!program || slot < 0 || slot >= static_cast<int>(program->uniforms.size())) {
+        return nullptr;
+    }
+
+    ShaderUniform& uniform = program->uniforms[slot];
+    if (uniform.hasValue && std::memcmp(uniform.value, value, count * sizeof(float)) == 0) {
+        return nullptr;
+    }
+
+    std::memcpy(uniform.value, value, count * sizeof(float));
+    uniform.hasValue = true;
+    return &uniform;
+}
+
+void glShaderSetInt(int shader, int slot, int value)
+{
+    float stored = static_cast<float>(value);
+    if (ShaderUniform* uniform = shaderPrepareSet(shader, slot, &stored, 1)) {
+        glUniform1i(uniform->location, value);
+    }
+}
+
+void glShaderSetFloat(int shader, int slot, float value)
+{
+    if (ShaderUniform* uniform = shaderPrepareSet(shader, slot, &value, 1)) {
+        glUniform1f(uniform->location, value);
+    }
+}
+
+void glShaderSetVec2(int shader, int slot, vec2 value)
+{
+    const float v[2] = {value.x, value.y};
+    if (ShaderUniform* uniform = shaderPrepareSet(shader, slot, v, 2)) {
+        glUniform2fv(uniform->location, 1, v);
+    }
+}
+
+void glShaderSetVec3(int shader, int slot, vec3 value)
+{
+    const float v[3] = {value.x, value.y, value.z};
+    if (ShaderUniform* uniform = shaderPrepareSet(shader, slot, v, 3)) {
+        glUniform3fv(uniform->location, 1, v);
+    }
+}
+
+void glShaderSetVec4(int shader, int slot, vec4 value)
+{
+    const float v[4] = {value.x, value.y, value.z, value.w};
+    if (ShaderUniform* uniform = shaderPrepareSet(shader, slot, v, 4)) {
+        glUniform4fv(uniform->location, 1, v);
+    }
+}
+
+void glShaderSetMat4(int shader, int slot, const mat4& value)
+{
+    if (ShaderUniform* uniform = shaderPrepareSet(shader, slot, value.m, 16)) {
+        glUniformMatrix4fv(uniform->location, 1, GL_FALSE, value.m);
+    }
+}
+
+void glGlobalsInit(int screenWidth, int screenHeight)
+{
+    std::memset(&g_globals, 0, sizeof(g_globals));
+    const mat4 identity = mat4::identity();
+    std::memcpy(g_globals.projection, identity.m, sizeof(g_globals.projection));
+    std::memcpy(g_globals.view, identity.m, sizeof(g_globals.view));
+    g_globals.screenSize[0] = static_cast<float>(screenWidth);
+    g_globals.screenSize[1] = static_cast<float>(screenHeight);
+    g_globals.screenSize[2] = 1.0f / screenWidth;
+    g_globals.screenSize[3] = 1.0f / screenHeight;
+    g_globals.canvas[0] = static_cast<float>(screenWidth);
+    g_globals.canvas[1] = static_cast<float>(screenHeight);
+    g_globals.canvas[2] = 1.0f / screenWidth;
+    g_globals.canvas[3] = 1.0f / screenHeight;
+
+    glGenBuffers(1, &g_globalsUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, g_globalsUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(GlobalsBlock), &g_globals, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // the binding never changes, programs are pointed at it when they are linked
+    glBindBufferBase(GL_UNIFORM_BUFFER, GLOBALS_BINDING, g_globalsUBO);
+    g_globalsDirty = false;
+}
+
+void glGlobalsSetCamera(const mat4& projection, const mat4& view)
+{
+    if (std::memcmp(g_globals.projection, projection.m, sizeof(g_globals.projection)) != 0) {
+        std::memcpy(g_globals.projection, projection.m, sizeof(g_globals.projection));
+        g_globalsDirty = true;
+    }
+    if (std::memcmp(g_globals.view, view.m, sizeof(g_globals.view)) != 0) {
+        std::memcpy(g_globals.view, view.m, sizeof(g_globals.view));
+        g_globalsDirty = true;
+    }
+}
+
+void glGlobalsSetCanvas(float width, float height)
+{
+    if (g_globals.canvas[0] == width && g_globals.canvas[1] == height) {
+        return;
+    }
+
+    g_globals.canvas[0] = width;
+    g_globals.canvas[1] = height;
+    g_globals.canvas[2] = 1.0f / width;
+    g_globals.canvas[3] = 1.0f / height;
+    g_globalsDirty = true;
+}
+
+vec2 glGlobalsGetCanvas()
+{
+    return vec2(g_globals.canvas[0], g_globals.canvas[1]);
+}
+
+void glGlobalsSetTime(float time)
+{
+    g_globals.time = time;
+    g_globalsDirty = true;
+}
+
+void glGlobalsSync()
+{
+    if (!g_globalsDirty || g_globalsUBO == 0) {
+        return;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, g_globalsUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(GlobalsBlock), &g_globals);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    g_globalsDirty = false;
+}
@@ -0,0 +1,204 @@
+#include "glint/glint.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gl_internal.h"
+
+// compiled programs are stored next to the system data, one file per program
+#define SHADER_CACHE_DIR "sys/shadercache/"
+
+// bump when the file layout or the injected shader prelude changes meaning
+#define SHADER_CACHE_VERSION 1
+
+struct ShaderCacheHeader {
+    char magic[4];          // "GLSC"
+    uint32_t version;
+    uint64_t key;
+    uint32_t sourceSize;    // vertex + fragment length, a cheap second check against hash collisions
+    uint32_t binaryFormat;
+    uint32_t binarySize;
+    float compileMs;        // what building the program from source cost, for the time-saved counter
+};
+
+static GlShaderCacheStats g_shaderCacheStats;
+static int g_shaderCacheSupported = -1;     // -1 until the driver has been asked
+static std::string g_shaderCacheDriver;
+
+static double shaderCacheNow()
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+static bool shaderCacheSupported()
+{
+    if (g_shaderCacheSupported >= 0) {
+        return g_shaderCacheSupported == 1;
+    }
+
+    g_shaderCacheSupported = 0;
+
+    const char* env = std::getenv("GLINT_SHADER_CACHE");
+    if (env && std::strcmp(env, "0") == 0) {
+        ioDebugPrint("Shader cache disabled by GLINT_SHADER_CACHE=0\n");
+        return false;
+    }
+
+    if (!GLAD_GL_ES_VERSION_3_0) {
+        return false;
+    }
+
+    int formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if (formatCount <= 0) {
+        ioDebugPrint("Shader cache unavailable: driver exposes no program binary formats\n");
+        return false;
+    }
+
+    // a binary is only valid for the driver build that produced it
+    const char* vendor = (const char*)glGetString(GL_VENDOR);
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    const char* version = (const char*)glGetString(GL_VERSION);
+    g_shaderCacheDriver = std::string(vendor ? vendor : "") + "|" + (renderer ? renderer : "") + "|" + (version ? version : "");
+
+    fsCreateDirectory(SHADER_CACHE_DIR);
+    g_shaderCacheSupported = 1;
+    return true;
+}
+
+static uint64_t shaderCacheHash(uint64_t hash, const char* data, size_t size)
+{
+    // FNV-1a, 64 bit; the terminating zero is included so "ab"+"c" and "a"+"bc" differ
+    for (size_t i = 0; i <= size; ++i) {
+        hash ^= (i < size) ? static_cast<unsigned char>(data[i]) : 0;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t shaderCacheKey(const std::string& vertexSource, const std::string& fragmentSource)
+{
+    uint64_t hash = 14695981039346656037ull;
+    hash ^= SHADER_CACHE_VERSION;
+    hash = shaderCacheHash(hash, g_shaderCacheDriver.c_str(), g_shaderCacheDriver.size());
+    hash = shaderCacheHash(hash, vertexSource.c_str(), vertexSource.size());
+    hash = shaderCacheHash(hash, fragmentSource.c_str(), fragmentSource.size());
+    return hash;
+}
+
+static std::string shaderCachePath(uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return std::string(SHADER_CACHE_DIR) + name;
+}
+
+unsigned int glShaderCacheLoad(const std::string& vertexSource, const std::string& fragmentSource)
+{
+    if (!shaderCacheSupported()) {
+        return 0;
+    }
+
+    double start = shaderCacheNow();
+    uint64_t key = shaderCacheKey(vertexSource, fragmentSource);
+    std::string path = shaderCachePath(key);
+    if (!fsFileExists(path.c_str())) {
+        return 0;
+    }
+
+    size_t size = 0;
+    const unsigned char* data = static_cast<const unsigned char*>(fsReadFile(path.c_str(), &size));
+    if (!data) {
+        return 0;
+    }
+
+    ShaderCacheHeader header;
+    bool valid = size >= sizeof(header);
+    if (valid) {
+        std::memcpy(&header, data, sizeof(header));
+        valid = std::memcmp(header.magic, "GLSC", 4) == 0 &&
+                header.version == SHADER_CACHE_VERSION &&
+                header.key == key &&
+                header.sourceSize == vertexSource.size() + fragmentSource.size() &&
+                sizeof(header) + header.binarySize <= size;
+    }
+
+    unsigned int program = 0;
+    if (valid) {
+        program = glCreateProgram();
+        glProgramBinary(program, header.binaryFormat, data + sizeof(header), header.binarySize);
+    }
+    delete[] reinterpret_cast<const char*>(data);
+
+    int linked = 0;
+    if (program) {
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    }
+
+    if (!linked) {
+        // stale or foreign blob (driver update, corrupt file): compile from source and overwrite it
+        if (program) {
+            glDeleteProgram(program);
+        }
+        g_shaderCacheStats.rejected++;
+        ioDebugPrint("Cached program %s rejected, compiling from source\n", path.c_str());
+        return 0;
+    }
+
+    double loadMs = shaderCacheNow() - start;
+    g_shaderCacheStats.hits++;
+    g_shaderCacheStats.loadMs += loadMs;
+    g_shaderCacheStats.savedMs += std::max(0.0, header.compileMs - loadMs);
+    return program;
+}
+
+void glShaderCacheStore(unsigned int program, const std::string& vertexSource, const std::string& fragmentSource, double compileMs)
+{
+    g_shaderCacheStats.misses++;
+    g_shaderCacheStats.compileMs += compileMs;
+
+    if (!shaderCacheSupported()) {
+        return;
+    }
+
+    int binarySize = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+    if (binarySize <= 0) {
+        return;
+    }
+
+    std::vector<unsigned char> file(sizeof(ShaderCacheHeader) + binarySize);
+
+    GLenum binaryFormat = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, binarySize, &written, &binaryFormat, file.data() + sizeof(ShaderCacheHeader));
+    if (written <= 0) {
+        return;
+    }
+
+    ShaderCacheHeader header;
+    std::memcpy(header.magic, "GLSC", 4);
+    header.version = SHADER_CACHE_VERSION;
+    header.key = shaderCacheKey(vertexSource, fragmentSource);
+    header.sourceSize = static_cast<uint32_t>(vertexSource.size() + fragmentSource.size());
+    header.binaryFormat = binaryFormat;
+    header.binarySize = static_cast<uint32_t>(written);
+    header.compileMs = static_cast<float>(compileMs);
+    std::memcpy(file.data(), &header, sizeof(header));
+
+    std::string path = shaderCachePath(header.key);
+    fsWriteFile(path.c_str(), file.data(), sizeof(header) + written);
+}
+
+GlShaderCacheStats glGetShaderCacheStats()
+{
+    return g_shaderCacheStats;
+}
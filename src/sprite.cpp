@@ -0,0 +1,247 @@
+#include "glint/glint.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "gl_internal.h"
+
+// indices are 16 bit, so a single flush can address at most 65536 / 4 quads
+#define SPRITE_BATCH_MAX_QUADS 16384
+
+// how many earlier groups a sprite may be moved back across when looking for a matching group
+#define SPRITE_BATCH_LOOKBACK 32
+
+struct SpriteVertex {
+    float x, y;
+    float u, v;
+    float r, g, b, a;
+};
+
+struct SpriteGroup {
+    int shader;
+    int texture;
+    float minX, minY, maxX, maxY;
+    int count;
+    int first;
+};
+
+static unsigned int g_spriteVAO = 0;
+static unsigned int g_spriteVBO = 0;
+static unsigned int g_spriteEBO = 0;
+static unsigned int g_spriteWhiteTexture = 0;
+static int g_spriteShader = 0;
+
+static std::vector<GlSprite> g_sprites;
+static std::vector<int> g_spriteGroupIndex;
+static std::vector<SpriteGroup> g_groups;
+static std::vector<SpriteVertex> g_vertices;
+static std::vector<int> g_groupCursor;
+
+void glSpriteBatchInit()
+{
+    // static index buffer: every quad is two triangles over four vertices
+    std::vector<unsigned short> indices(SPRITE_BATCH_MAX_QUADS * 6);
+    for (int i = 0; i < SPRITE_BATCH_MAX_QUADS; ++i) {
+        unsigned short base = static_cast<unsigned short>(i * 4);
+        indices[i * 6 + 0] = base + 0;
+        indices[i * 6 + 1] = base + 1;
+        indices[i * 6 + 2] = base + 2;
+        indices[i * 6 + 3] = base + 0;
+        indices[i * 6 + 4] = base + 2;
+        indices[i * 6 + 5] = base + 3;
+    }
+
+    glGenVertexArrays(1, &g_spriteVAO);
+    glGenBuffers(1, &g_spriteVBO);
+    glGenBuffers(1, &g_spriteEBO);
+
+    glStateBindVertexArray(g_spriteVAO);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_spriteEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), indices.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, g_spriteVBO);
+    glEnableVertexAttribArray(0); // Position (screen space)
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, x));
+    glEnableVertexAttribArray(1); // TexCoords
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, u));
+    glEnableVertexAttribArray(2); // Tint + alpha
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, r));
+
+    glStateBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // 1x1 white texture for untextured sprites
+    const unsigned char white[4] = {255, 255, 255, 255};
+    glGenTextures(1, &g_spriteWhiteTexture);
+    glStateBindTexture(0, g_spriteWhiteTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glStateBindTexture(0, 0);
+
+    g_spriteShader = glGenerateShader(
+        R"(
+        #version 300 es
+        layout(location = 0) in vec2 aPos;
+        layout(location = 1) in vec2 aTexCoord;
+        layout(location = 2) in vec4 aColor;
+
+        out vec2 TexCoord;
+        out vec4 Color;
+
+        void main() {
+            gl_Position = glintCanvasToClip(aPos);
+            TexCoord = aTexCoord;
+            Color = aColor;
+        }
+        )",
+        R"(
+        #version 300 es
+        precision mediump float;
+
+        in vec2 TexCoord;
+        in vec4 Color;
+        uniform sampler2D tex;
+
+        out vec4 FragColor;
+
+        void main() {
+            FragColor = texture(tex, TexCoord) * Color;
+        }
+        )"
+    );
+
+    g_sprites.reserve(256);
+}
+
+static bool spriteOverlaps(const SpriteGroup& group, float minX, float minY, float maxX, float maxY)
+{
+    return minX < group.maxX && maxX > group.minX && minY < group.maxY && maxY > group.minY;
+}
+
+void glSpriteBatchDraw(const GlSprite& sprite)
+{
+    if (g_sprites.size() >= SPRITE_BATCH_MAX_QUADS) {
+        glSpriteBatchFlush();
+    }
+
+    g_sprites.push_back(sprite);
+}
+
+void glSpriteBatchFlush()
+{
+    if (g_sprites.empty()) {
+        return;
+    }
+
+    int spriteCount = static_cast<int>(g_sprites.size());
+
+    // group sprites by (shader, texture). a sprite may only join an earlier group when it
+    // does not overlap anything submitted in between, so blending order is preserved.
+    g_groups.clear();
+    g_spriteGroupIndex.resize(spriteCount);
+
+    for (int i = 0; i < spriteCount; ++i) {
+        const GlSprite& s = g_sprites[i];
+        int shader = (s.shader != 0) ? s.shader : g_spriteShader;
+        int texture = (s.texture != 0) ? s.texture : static_cast<int>(g_spriteWhiteTexture);
+
+        float minX = std::min(s.x, s.x + s.width);
+        float maxX = std::max(s.x, s.x + s.width);
+        float minY = std::min(s.y, s.y + s.height);
+        float maxY = std::max(s.y, s.y + s.height);
+
+        int target = -1;
+        int lookbackEnd = std::max(0, static_cast<int>(g_groups.size()) - SPRITE_BATCH_LOOKBACK);
+        for (int g = static_cast<int>(g_groups.size()) - 1; g >= lookbackEnd; --g) {
+            if (g_groups[g].shader == shader && g_groups[g].texture == texture) {
+                target = g;
+                break;
+            }
+            if (spriteOverlaps(g_groups[g], minX, minY, maxX, maxY)) {
+                break;
+            }
+        }
+
+        if (target < 0) {
+            SpriteGroup group;
+            group.shader = shader;
+            group.texture = texture;
+            group.minX = minX;
+            group.minY = minY;
+            group.maxX = maxX;
+            group.maxY = maxY;
+            group.count = 0;
+            group.first = 0;
+            g_groups.push_back(group);
+            target = static_cast<int>(g_groups.size()) - 1;
+        } else {
+            SpriteGroup& group = g_groups[target];
+            group.minX = std::min(group.minX, minX);
+            group.minY = std::min(group.minY, minY);
+            group.maxX = std::max(group.maxX, maxX);
+            group.maxY = std::max(group.maxY, maxY);
+        }
+
+        g_groups[target].count++;
+        g_spriteGroupIndex[i] = target;
+    }
+
+    // lay the vertices out group after group, keeping submission order inside a group
+    int groupCount = static_cast<int>(g_groups.size());
+    g_groupCursor.resize(groupCount);
+    int running = 0;
+    for (int g = 0; g < groupCount; ++g) {
+        g_groups[g].first = running;
+        g_groupCursor[g] = running;
+        running += g_groups[g].count;
+    }
+
+    g_vertices.resize(spriteCount * 4);
+    for (int i = 0; i < spriteCount; ++i) {
+        const GlSprite& s = g_sprites[i];
+        SpriteVertex* v = &g_vertices[g_groupCursor[g_spriteGroupIndex[i]]++ * 4];
+
+        float x0 = s.x, y0 = s.y;
+        float x1 = s.x + s.width, y1 = s.y + s.height;
+
+        v[0] = {x0, y0, s.u0, s.v0, s.tint.r, s.tint.g, s.tint.b, s.alpha};
+        v[1] = {x1, y0, s.u1, s.v0, s.tint.r, s.tint.g, s.tint.b, s.alpha};
+        v[2] = {x1, y1, s.u1, s.v1, s.tint.r, s.tint.g, s.tint.b, s.alpha};
+        v[3] = {x0, y1, s.u0, s.v1, s.tint.r, s.tint.g, s.tint.b, s.alpha};
+    }
+
+    // remember the caller's program and texture so immediate-mode callers are unaffected
+    int prevProgram = glStateGetProgram();
+    int prevTexture = glStateGetTexture(0);
+
+    glStateBindVertexArray(g_spriteVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, g_spriteVBO);
+    glBufferData(GL_ARRAY_BUFFER, g_vertices.size() * sizeof(SpriteVertex), nullptr, GL_STREAM_DRAW); // orphan
+    glBufferSubData(GL_ARRAY_BUFFER, 0, g_vertices.size() * sizeof(SpriteVertex), g_vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glGlobalsSync();
+
+    for (const SpriteGroup& group : g_groups) {
+        glShaderUse(group.shader);
+
+        // vertices are already in screen space, neutralise the quad transform of legacy shaders
+        glShaderSetVec2(group.shader, glShaderBuiltinSlot(group.shader, SHADER_SLOT_POSITION), vec2(0.0f, 0.0f));
+        glShaderSetVec2(group.shader, glShaderBuiltinSlot(group.shader, SHADER_SLOT_SCALE), vec2(1.0f, 1.0f));
+
+        if (group.texture >= 0) {
+            glStateBindTexture(0, group.texture);
+        }
+
+        glDrawElements(GL_TRIANGLES, group.count * 6, GL_UNSIGNED_SHORT, (void*)(group.first * 6 * sizeof(unsigned short)));
+    }
+
+    glStateBindTexture(0, prevTexture);
+    glShaderUse(prevProgram);
+
+    g_sprites.clear();
+}
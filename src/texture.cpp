@@ -0,0 +1,649 @@
+#include "glint/glint.h"
+
+#include <glad/glad.h>
+#include <stb/stb_image.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gl_internal.h"
+#include "jobs_internal.h"
+
+// default budget for textures nobody holds anymore; textures in use are never evicted
+#define TEXTURE_DEFAULT_BUDGET (64u * 1024u * 1024u)
+
+struct TextureEntry {
+    int width;
+    int height;
+    size_t bytes;
+    int refCount;
+    bool cached;                        // false for raw uploads, which are deleted as soon as they are released
+    unsigned int version;               // from g_textureVersion, so a recycled texture name never repeats one
+    std::vector<std::string> keys;      // path and/or content keys that resolve to this texture
+    std::list<int>::iterator unusedIt;  // position in g_unusedTextures while refCount == 0
+};
+
+static std::unordered_map<int, TextureEntry> g_textures;
+static std::unordered_map<std::string, int> g_textureKeys;
+static std::list<int> g_unusedTextures; // least recently released first
+
+static size_t g_textureBudget = TEXTURE_DEFAULT_BUDGET;
+static unsigned int g_textureVersion = 0;
+static GlTextureStats g_textureStats;
+
+// async loads are decoded on the job pool and uploaded on the GL thread from glPresent
+#define TEXTURE_UPLOAD_PBOS 2
+#define TEXTURE_UPLOAD_BYTES_PER_FRAME (8u * 1024u * 1024u)
+
+struct TextureDecodeResult {
+    int texture;
+    unsigned int ticket;        // matches g_pendingTextures, so a deleted and reused name is never overwritten
+    unsigned char* pixels;      // stb allocation, null when the load failed
+    int width;
+    int height;
+    int channels;
+    std::vector<unsigned char> ktx;     // compressed images skip decoding, the file is uploaded as is
+    std::string contentKey;
+};
+
+// KTX 1.1 container, written by glt_execcreate for ETC2 compressed images
+struct TextureKtxHeader {
+    uint8_t identifier[12];
+    uint32_t endianness;
+    uint32_t glType;
+    uint32_t glTypeSize;
+    uint32_t glFormat;
+    uint32_t glInternalFormat;
+    uint32_t glBaseInternalFormat;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t numberOfArrayElements;
+    uint32_t numberOfFaces;
+    uint32_t numberOfMipmapLevels;
+    uint32_t bytesOfKeyValueData;
+};
+
+struct TextureKtx {
+    unsigned int internalFormat;
+    int width;
+    int height;
+    std::vector<const unsigned char*> levels;
+    std::vector<uint32_t> levelSizes;
+};
+
+static const uint8_t g_ktxIdentifier[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+static std::mutex g_decodedMutex;
+static std::deque<TextureDecodeResult> g_decodedTextures;      // filled by workers
+
+static std::unordered_map<int, unsigned int> g_pendingTextures; // GL thread only
+static unsigned int g_nextTicket = 1;
+static unsigned int g_uploadPBOs[TEXTURE_UPLOAD_PBOS] = {};
+static int g_nextUploadPBO = 0;
+
+static uint64_t textureHash(const unsigned char* data, size_t size)
+{
+    // FNV-1a, 64 bit
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static std::string texturePathKey(const char* filePath, int desiredChannels)
+{
+    return std::string("path:") + filePath + "#" + std::to_string(desiredChannels);
+}
+
+static std::string textureContentKey(uint64_t hash, size_t size, int desiredChannels)
+{
+    char key[64];
+    snprintf(key, sizeof(key), "data:%016llx:%zu#%d", static_cast<unsigned long long>(hash), size, desiredChannels);
+    return key;
+}
+
+static void textureDelete(int texture)
+{
+    auto it = g_textures.find(texture);
+    if (it == g_textures.end()) {
+        return;
+    }
+
+    for (const std::string& key : it->second.keys) {
+        g_textureKeys.erase(key);
+    }
+
+    g_textureStats.residentBytes -= it->second.bytes;
+    g_textureStats.textureCount--;
+    g_textures.erase(it);
+    g_pendingTextures.erase(texture);
+
+    glStateForgetTexture(texture);
+    GLuint tex = texture;
+    glDeleteTextures(1, &tex);
+}
+
+// drops released textures, oldest first, until resident memory fits the budget again
+static void textureEvict()
+{
+    while (g_textureStats.residentBytes > g_textureBudget && !g_unusedTextures.empty()) {
+        int texture = g_unusedTextures.front();
+        g_unusedTextures.pop_front();
+        g_textureStats.unusedCount--;
+        g_textureStats.evictions++;
+        textureDelete(texture);
+    }
+}
+
+static int textureAcquire(const std::string& key)
+{
+    auto keyIt = g_textureKeys.find(key);
+    if (keyIt == g_textureKeys.end()) {
+        return 0;
+    }
+
+    TextureEntry& entry = g_textures[keyIt->second];
+    if (entry.refCount == 0) {
+        g_unusedTextures.erase(entry.unusedIt);
+        g_textureStats.unusedCount--;
+    }
+    entry.refCount++;
+    g_textureStats.hits++;
+    return keyIt->second;
+}
+
+static void textureAddKey(int texture, const std::string& key)
+{
+    g_textureKeys[key] = texture;
+    g_textures[texture].keys.push_back(key);
+}
+
+void glTextureRegister(int texture, int width, int height, size_t bytes, bool cached)
+{
+    if (texture == 0) {
+        return;
+    }
+
+    TextureEntry& entry = g_textures[texture];
+    entry = TextureEntry();
+    entry.width = width;
+    entry.height = height;
+    entry.bytes = bytes;
+    entry.refCount = 1;
+    entry.cached = cached;
+    entry.version = ++g_textureVersion;
+
+    g_textureStats.residentBytes += bytes;
+    g_textureStats.textureCount++;
+    textureEvict();
+}
+
+void glTextureTouch(int texture)
+{
+    auto it = g_textures.find(texture);
+    if (it != g_textures.end()) {
+        it->second.version = ++g_textureVersion;
+    }
+}
+
+unsigned int glTextureGetVersion(int texture)
+{
+    auto it = g_textures.find(texture);
+    return (it != g_textures.end()) ? it->second.version : 0;
+}
+
+static bool textureIsKtx(const unsigned char* data, size_t size)
+{
+    return size >= sizeof(TextureKtxHeader) && std::memcmp(data, g_ktxIdentifier, sizeof(g_ktxIdentifier)) == 0;
+}
+
+// only single 2D ETC2 images are accepted, which is what the resource packer writes
+static bool textureParseKtx(const unsigned char* data, size_t size, TextureKtx* ktx)
+{
+    TextureKtxHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (header.endianness != 0x04030201 || header.glType != 0 || header.pixelDepth > 1 ||
+        header.numberOfArrayElements > 0 || header.numberOfFaces != 1) {
+        ioDebugPrint("Unsupported KTX layout\n");
+        return false;
+    }
+
+    if (header.glInternalFormat != GL_COMPRESSED_RGB8_ETC2 && header.glInternalFormat != GL_COMPRESSED_RGBA8_ETC2_EAC) {
+        ioDebugPrint("Unsupported KTX format: 0x%04x\n", header.glInternalFormat);
+        return false;
+    }
+
+    ktx->internalFormat = header.glInternalFormat;
+    ktx->width = header.pixelWidth;
+    ktx->height = header.pixelHeight;
+    ktx->levels.clear();
+    ktx->levelSizes.clear();
+
+    size_t offset = sizeof(header) + header.bytesOfKeyValueData;
+    uint32_t levelCount = std::max(header.numberOfMipmapLevels, 1u);
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        uint32_t imageSize;
+        if (offset + sizeof(imageSize) > size) {
+            break;
+        }
+        std::memcpy(&imageSize, data + offset, sizeof(imageSize));
+        offset += sizeof(imageSize);
+        if (offset + imageSize > size) {
+            break;
+        }
+
+        ktx->levels.push_back(data + offset);
+        ktx->levelSizes.push_back(imageSize);
+        offset += (imageSize + 3) & ~3u;
+    }
+
+    if (ktx->levels.empty()) {
+        ioDebugPrint("Truncated KTX texture\n");
+        return false;
+    }
+    return true;
+}
+
+// uploads every level to the texture bound on unit 0 and returns the GPU bytes used
+static size_t textureUploadKtx(const TextureKtx& ktx)
+{
+    size_t bytes = 0;
+    int levelCount = static_cast<int>(ktx.levels.size());
+    for (int level = 0; level < levelCount; ++level) {
+        int width = std::max(ktx.width >> level, 1);
+        int height = std::max(ktx.height >> level, 1);
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, ktx.internalFormat, width, height, 0, ktx.levelSizes[level], ktx.levels[level]);
+        bytes += ktx.levelSizes[level];
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (levelCount > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    return bytes;
+}
+
+int glGenerateTexture(int width, int height, const unsigned char *data, int desiredChannels)
+{
+    // 4. Standard OpenGLES Texture Upload
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glStateBindTexture(0, tex);
+
+    // Critical: Font textures often have non-power-of-two widths
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    GLenum format = (desiredChannels == 4) ? GL_RGBA : GL_RGB;
+    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // raw pixels are not worth hashing, they are tracked but never shared
+    glTextureRegister(tex, width, height, static_cast<size_t>(width) * height * ((desiredChannels == 4) ? 4 : 3), false);
+
+    return tex;
+}
+
+// decodes and uploads an encoded image, or returns the texture already holding the same content
+static int textureLoadEncoded(const unsigned char *data, int dataSize, int desired_channels)
+{
+    std::string contentKey = textureContentKey(textureHash(data, dataSize), dataSize, desired_channels);
+
+    int cachedTexture = textureAcquire(contentKey);
+    if (cachedTexture) {
+        return cachedTexture;
+    }
+
+    g_textureStats.misses++;
+
+    // ETC2 images from the resource packer go to the GPU as they are; everything else is decoded
+    if (textureIsKtx(data, dataSize)) {
+        TextureKtx ktx;
+        if (!textureParseKtx(data, dataSize, &ktx)) {
+            return 0;
+        }
+
+        GLuint tex;
+        glGenTextures(1, &tex);
+        glStateBindTexture(0, tex);
+        size_t bytes = textureUploadKtx(ktx);
+
+        ioDebugPrint("Compressed texture loaded: %dx%d, ID: %u\n", ktx.width, ktx.height, tex);
+
+        glTextureRegister(tex, ktx.width, ktx.height, bytes, true);
+        textureAddKey(tex, contentKey);
+        return tex;
+    }
+
+    int width, height, channels_in_file;
+    // Request 4 components (RGBA) for consistency, but you can use 0 to let it decide.
+
+    ioDebugPrint("Loading texture from memory (size: %d bytes, desired channels: %d)...\n", dataSize, desired_channels);
+
+    unsigned char* image_data = stbi_load_from_memory(
+        data,
+        dataSize,
+        &width,
+        &height,
+        &channels_in_file,
+        desired_channels
+    );
+
+    if (image_data == NULL) {
+        ioDebugPrint("Failed to load TGA image from memory: %s\n", stbi_failure_reason());
+        return 0;
+    }
+
+    // 4. Standard OpenGLES Texture Upload
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glStateBindTexture(0, tex);
+
+    ioDebugPrint("Texture loaded: %dx%d, channels in file: %d\n", width, height, channels_in_file);
+
+    // Critical: Font textures often have non-power-of-two widths
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // Use desired_channels (what stbi actually returned), not channels_in_file (what the file originally had)
+    int actual_channels = (desired_channels != 0) ? desired_channels : channels_in_file;
+    GLenum format = (actual_channels == 4) ? GL_RGBA : GL_RGB;
+    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, image_data);
+
+    ioDebugPrint("Texture generated with ID: %u\n", tex);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    stbi_image_free(image_data);
+
+    ioDebugPrint("Texture upload complete\n");
+
+    glTextureRegister(tex, width, height, static_cast<size_t>(width) * height * ((actual_channels == 4) ? 4 : 3), true);
+    textureAddKey(tex, contentKey);
+
+    return tex;
+}
+
+int glGenerateTexture(const unsigned char *data, int dataSize, int desired_channels)
+{
+    return textureLoadEncoded(data, dataSize, desired_channels);
+}
+
+int glGenerateTexture(const char *filePath, int desiredChannels)
+{
+    // a path hit skips the file read as well as the decode
+    std::string pathKey = texturePathKey(filePath, desiredChannels);
+    int cachedTexture = textureAcquire(pathKey);
+    if (cachedTexture) {
+        return cachedTexture;
+    }
+
+    ioDebugPrint("Loading texture from file: %s\n", filePath);
+
+    // resource paths point into the mounted pack; anything else is a copy this function owns
+    bool isResource = filePath[0] && filePath[1] == ':' && filePath[2] == '/';
+
+    size_t size = 0;
+    const void* fileData = fsReadFile(filePath, &size);
+
+    if (!fileData) {
+        ioDebugPrint("Failed to read file for texture: %s\n", filePath);
+        return 0;
+    }
+
+    // the same image under another path (or already loaded from memory) shares the texture
+    int tex = 0;
+    if (size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        ioDebugPrint("Texture file too large to decode safely: %s (size: %zu bytes)\n", filePath, size);
+    } else {
+        tex = textureLoadEncoded((const unsigned char*)fileData, static_cast<int>(size), desiredChannels);
+    }
+
+    if (!isResource) {
+        delete[] reinterpret_cast<const char*>(fileData);
+    }
+
+    if (tex) {
+        textureAddKey(tex, pathKey);
+    }
+    return tex;
+}
+
+void glReleaseTexture(int texture)
+{
+    auto it = g_textures.find(texture);
+    if (it == g_textures.end() || it->second.refCount <= 0) {
+        return;
+    }
+
+    TextureEntry& entry = it->second;
+    if (--entry.refCount > 0) {
+        return;
+    }
+
+    if (!entry.cached) {
+        textureDelete(texture);
+        return;
+    }
+
+    // keep it resident so a reload is free, until the budget needs the memory
+    entry.unusedIt = g_unusedTextures.insert(g_unusedTextures.end(), texture);
+    g_textureStats.unusedCount++;
+    textureEvict();
+}
+
+void glTextureSetBudget(size_t bytes)
+{
+    g_textureBudget = bytes;
+    textureEvict();
+}
+
+bool glTextureGetSize(int texture, int* width, int* height)
+{
+    auto it = g_textures.find(texture);
+    if (it == g_textures.end()) {
+        return false;
+    }
+
+    if (width) *width = it->second.width;
+    if (height) *height = it->second.height;
+    return true;
+}
+
+GlTextureStats glGetTextureStats()
+{
+    GlTextureStats stats = g_textureStats;
+    stats.budget = g_textureBudget;
+    return stats;
+}
+
+static unsigned char* textureDecode(const unsigned char* data, int dataSize, int desiredChannels, int* width, int* height, int* channels)
+{
+    int channelsInFile = 0;
+    unsigned char* pixels = stbi_load_from_memory(data, dataSize, width, height, &channelsInFile, desiredChannels);
+    *channels = (desiredChannels != 0) ? desiredChannels : channelsInFile;
+    return pixels;
+}
+
+int glGenerateTextureAsync(const char *filePath, int desiredChannels)
+{
+    std::string pathKey = texturePathKey(filePath, desiredChannels);
+    int cachedTexture = textureAcquire(pathKey);
+    if (cachedTexture) {
+        return cachedTexture;
+    }
+
+    g_textureStats.misses++;
+
+    // transparent 1x1 placeholder, so frames using the handle draw nothing until the image lands
+    const unsigned char placeholder[4] = {0, 0, 0, 0};
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glStateBindTexture(0, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glTextureRegister(tex, 1, 1, sizeof(placeholder), true);
+    textureAddKey(tex, pathKey);
+
+    unsigned int ticket = g_nextTicket++;
+    g_pendingTextures[tex] = ticket;
+
+    // the mount table may change under a job, so resource paths are resolved here; pack data is never freed and
+    // can be decoded from any thread, while other files are read on the job
+    bool isResource = filePath[0] && filePath[1] == ':' && filePath[2] == '/';
+    size_t resourceSize = 0;
+    const void* resourceData = isResource ? fsReadFile(filePath, &resourceSize) : nullptr;
+
+    std::string path = filePath;
+    jobsSubmit([tex, ticket, path, desiredChannels, isResource, resourceData, resourceSize]() {
+        TextureDecodeResult result;
+        result.texture = tex;
+        result.ticket = ticket;
+        result.pixels = nullptr;
+        result.width = 0;
+        result.height = 0;
+        result.channels = 0;
+
+        size_t size = resourceSize;
+        const void* fileData = isResource ? resourceData : fsReadFile(path.c_str(), &size);
+        if (!fileData) {
+            ioDebugPrint("Failed to read file for texture: %s\n", path.c_str());
+        } else if (size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+            ioDebugPrint("Texture file too large to decode safely: %s (size: %zu bytes)\n", path.c_str(), size);
+        } else {
+            const unsigned char* data = static_cast<const unsigned char*>(fileData);
+            result.contentKey = textureContentKey(textureHash(data, size), size, desiredChannels);
+            if (textureIsKtx(data, size)) {
+                result.ktx.assign(data, data + size);
+            } else {
+                result.pixels = textureDecode(data, static_cast<int>(size), desiredChannels, &result.width, &result.height, &result.channels);
+            }
+            if (!result.pixels && result.ktx.empty()) {
+                ioDebugPrint("Failed to decode texture: %s\n", path.c_str());
+            }
+        }
+
+        // resource data points into the mounted pack; anything else is a copy owned here
+        if (fileData && !isResource) {
+            delete[] reinterpret_cast<const char*>(fileData);
+        }
+
+        std::lock_guard<std::mutex> lock(g_decodedMutex);
+        g_decodedTextures.push_back(std::move(result));
+    });
+
+    return tex;
+}
+
+static void textureUploadPixels(int texture, const unsigned char* pixels, int width, int height, int channels)
+{
+    GLenum format = (channels == 4) ? GL_RGBA : GL_RGB;
+    size_t bytes = static_cast<size_t>(width) * height * channels;
+
+    glStateBindTexture(0, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (!GLAD_GL_ES_VERSION_3_0) {
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+        return;
+    }
+
+    if (g_uploadPBOs[0] == 0) {
+        glGenBuffers(TEXTURE_UPLOAD_PBOS, g_uploadPBOs);
+    }
+
+    // round-robin over the unpack buffers so a new upload never waits on the previous transfer
+    unsigned int pbo = g_uploadPBOs[g_nextUploadPBO];
+    g_nextUploadPBO = (g_nextUploadPBO + 1) % TEXTURE_UPLOAD_PBOS;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped) {
+        std::memcpy(mapped, pixels, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    } else {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+    }
+}
+
+void glTextureUploadPump()
+{
+    // take a frame's worth of decoded images; at least one, so a single huge image still lands
+    std::vector<TextureDecodeResult> ready;
+    {
+        std::lock_guard<std::mutex> lock(g_decodedMutex);
+        size_t budget = 0;
+        while (!g_decodedTextures.empty() && (ready.empty() || budget < TEXTURE_UPLOAD_BYTES_PER_FRAME)) {
+            TextureDecodeResult& next = g_decodedTextures.front();
+            budget += static_cast<size_t>(next.width) * next.height * next.channels + next.ktx.size();
+            ready.push_back(std::move(next));
+            g_decodedTextures.pop_front();
+        }
+    }
+
+    for (TextureDecodeResult& result : ready) {
+        auto pending = g_pendingTextures.find(result.texture);
+        if (pending == g_pendingTextures.end() || pending->second != result.ticket) {
+            stbi_image_free(result.pixels); // released and deleted while it was decoding
+            continue;
+        }
+        g_pendingTextures.erase(pending);
+
+        size_t bytes = 0;
+        if (!result.ktx.empty()) {
+            // compressed images are a fraction of the size, they are uploaded straight from the file
+            TextureKtx ktx;
+            if (!textureParseKtx(result.ktx.data(), result.ktx.size(), &ktx)) {
+                continue; // keeps the placeholder
+            }
+            glStateBindTexture(0, result.texture);
+            bytes = textureUploadKtx(ktx);
+            result.width = ktx.width;
+            result.height = ktx.height;
+        } else if (result.pixels) {
+            textureUploadPixels(result.texture, result.pixels, result.width, result.height, result.channels);
+            stbi_image_free(result.pixels);
+            bytes = static_cast<size_t>(result.width) * result.height * ((result.channels == 4) ? 4 : 3);
+        } else {
+            continue; // keeps the placeholder
+        }
+
+        TextureEntry& entry = g_textures[result.texture];
+        g_textureStats.residentBytes += bytes - entry.bytes;
+        entry.width = result.width;
+        entry.height = result.height;
+        entry.bytes = bytes;
+        entry.version = ++g_textureVersion;
+
+        if (g_textureKeys.find(result.contentKey) == g_textureKeys.end()) {
+            textureAddKey(result.texture, result.contentKey);
+        }
+    }
+
+    if (!ready.empty()) {
+        textureEvict();
+    }
+}
+
+bool glTextureIsReady(int texture)
+{
+    return g_pendingTextures.find(texture) == g_pendingTextures.end();
+}
@@ -4,6 +4,7 @@
 #include <thread>
 #include <GLFW/glfw3.h>
 #include <glint/gl/gl.h>
+#include "gl_internal.h"
 
 
 TitleInfo titleLoadInfo(const char *path)
@@ -71,6 +72,7 @@ void p_exeTitle(void* handle, TitleThread* thread, void* glCtx) {
         if (result == 2)
         {
             ioDebugPrint("Title requested pause\n");
+            glResolutionSuspend(true);
             glfwMakeContextCurrent(nullptr);
             thread->isPaused = true;
         }
@@ -86,6 +88,7 @@ void p_exeTitle(void* handle, TitleThread* thread, void* glCtx) {
             if (!thread->isRunning) {
                 break;
             }
+            glResolutionSuspend(false);
         }
 
 
@@ -93,6 +96,7 @@ void p_exeTitle(void* handle, TitleThread* thread, void* glCtx) {
 
 
     execCallHandle(handle, "app_shutdown");
+    glDynamicResolutionDisable(); // a title that turned it on must not leave the home screen scaled
     glfwMakeContextCurrent(nullptr);
     thread->isPaused = true;
     
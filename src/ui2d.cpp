@@ -1,98 +1,531 @@
 #include "glint/glint.h"
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <limits>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include "gl_internal.h"
 
-static UiFrame& mainFrame = *new UiFrame();
-static std::vector<UiFrame*> allFrames;
+
+static UiFrame* mainFrame = nullptr;
+static std::vector<UiFrame*> allFrames;           // registration order, which breaks navigation ties
+static std::unordered_set<UiFrame*> allFrameSet;
 static UiFrame* selectedFrame = nullptr;
 
+// bumped whenever a resolved rect, a frame's selectability or the registry changes; navigation data built for
+// an older version is rebuilt on the next key press
+static unsigned int uiLayoutVersion = 0;
+
+// bumped whenever frames are added, moved to another parent or destroyed; the flattened tree is rebuilt for it
+static unsigned int uiTreeVersion = 0;
+
+// blur radii above this many texels are taken down a level of half-size targets first
+#define UI_BLUR_RADIUS_PER_LEVEL 4.0f
+#define UI_BLUR_MAX_DOWNSAMPLE 8
+
+// shadow masks not drawn for this many ui2dDraw calls are handed back to the render target pool
+#define UI_SHADOW_IDLE_FRAMES 60
+
+// frames per pool block; blocks never move, so references handed out by ui2dAddFrame stay valid as the pool grows
+#define UI_FRAME_BLOCK 64
+
+// navigation grid cell size in canvas units, grown when the selectable frames are spread wider than the cap
+#define UI_NAV_CELL_SIZE 64.0f
+#define UI_NAV_MAX_CELLS 64
+
 static int uiDefaultShader = 0;
 static int uiBlurShader = 0;
-static int uiShadowShader = 0;
-static int uiInnerShadowShader = 0;
+static int uiShadowBakeShader = 0;
+
+// effect shader uniform slots, resolved once in ui2dEnsureShaders
+static int uiBlurRadiusSlot = -1;
+static int uiBlurDirectionSlot = -1;
+static int uiShadowStepSlot = -1;
+static int uiShadowOffsetSlot = -1;
+static int uiShadowPassSlot = -1;
+static int uiShadowInnerSlot = -1;
+
+static int uiDrawCount = 0;
+
+struct UiFrameSlot {
+    UiFrame frame;
+    unsigned int generation = 1;
+    bool live = false;
+};
+
+// frame storage for ui2dAddFrame: fixed blocks of slots, with destroyed slots reused before the pool grows
+struct UiFramePool {
+    static std::vector<std::unique_ptr<UiFrameSlot[]>> blocks;
+    static std::vector<unsigned int> freeSlots;
+    static unsigned int slotCount;
+
+    static UiFrameSlot& slot(unsigned int index)
+    {
+        return blocks[index / UI_FRAME_BLOCK][index % UI_FRAME_BLOCK];
+    }
+
+    // the slot holding this exact frame; copies of a pooled frame carry its slot number but are not in it
+    static UiFrameSlot* slotOf(const UiFrame& frame)
+    {
+        if (frame.poolSlot >= slotCount) {
+            return nullptr;
+        }
+
+        UiFrameSlot& candidate = slot(frame.poolSlot);
+        return (&candidate.frame == &frame && candidate.live) ? &candidate : nullptr;
+    }
+
+    static unsigned int indexOf(const UiFrame& frame)
+    {
+        return frame.poolSlot;
+    }
+
+    static void setDestroyed(UiFrame& frame, bool destroyed)
+    {
+        frame.destroyed = destroyed;
+    }
+
+    static void detach(UiFrame& frame)
+    {
+        if (frame.parent) {
+            auto& siblings = frame.parent->children;
+            siblings.erase(std::remove(siblings.begin(), siblings.end(), &frame), siblings.end());
+            frame.parent->layoutDirty = true;
+            frame.parent = nullptr;
+        }
+    }
+
+    static UiFrame* allocate()
+    {
+        unsigned int index;
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            if (slotCount % UI_FRAME_BLOCK == 0) {
+                blocks.emplace_back(new UiFrameSlot[UI_FRAME_BLOCK]);
+            }
+            index = slotCount++;
+        }
+
+        UiFrameSlot& entry = slot(index);
+        entry.frame = UiFrame();
+        entry.frame.poolSlot = index;
+        entry.live = true;
+        return &entry.frame;
+    }
+
+    // handles to the frame stop resolving at once, but the slot keeps its contents until recycle, so a callback
+    // that destroyed its own frame can finish running
+    static bool retire(UiFrame& frame)
+    {
+        UiFrameSlot* entry = slotOf(frame);
+        if (!entry) {
+            return false;
+        }
+
+        entry->live = false;
+        if (++entry->generation == 0) {
+            entry->generation = 1;
+        }
+        return true;
+    }
 
-static void ui2dEnsureBlurTargets(UiEffectSettings& effects, int width, int height)
+    static void recycle(UiFrame& frame)
+    {
+        unsigned int index = frame.poolSlot;
+
+        // drops the callbacks' captures and the child list now rather than when the slot is next used
+        frame = UiFrame();
+        freeSlots.push_back(index);
+    }
+};
+
+std::vector<std::unique_ptr<UiFrameSlot[]>> UiFramePool::blocks;
+std::vector<unsigned int> UiFramePool::freeSlots;
+unsigned int UiFramePool::slotCount = 0;
+
+// ui2dUpdate and ui2dDraw calls in progress; frames destroyed meanwhile wait in uiRetiredFrames (with whether
+// they came from the pool) until the outermost call returns
+static int uiCallbackDepth = 0;
+static std::vector<std::pair<UiFrame*, bool>> uiRetiredFrames;
+
+static void ui2dBeginCallbacks()
 {
-    if (width <= 0 || height <= 0) {
+    uiCallbackDepth++;
+}
+
+static void ui2dEndCallbacks()
+{
+    if (--uiCallbackDepth > 0) {
         return;
     }
 
-    if (effects.blurPassesSetup && effects.blurTextureWidth == width && effects.blurTextureHeight == height) {
-        return;
+    for (auto& retired : uiRetiredFrames) {
+        UiFramePool::setDestroyed(*retired.first, false);
+        if (retired.second) {
+            UiFramePool::recycle(*retired.first);
+        }
     }
+    uiRetiredFrames.clear();
+}
 
-    if (!effects.blurPassesSetup) {
-        glGenFramebuffers(2, reinterpret_cast<GLuint*>(effects.blurFramebuffers));
-        glGenTextures(2, reinterpret_cast<GLuint*>(effects.blurTextures));
-        effects.blurPassesSetup = true;
+static UiFrame* ui2dRootFrame()
+{
+    if (!mainFrame) {
+        vec2 canvas = glCanvasGetSize();
+        mainFrame = UiFramePool::allocate();
+        mainFrame->width = canvas.x;
+        mainFrame->height = canvas.y;
     }
+    return mainFrame;
+}
+
+// binds a quad shader and sets the uniforms shared by all ui shaders
+static void ui2dUseQuadShader(int shader, float alpha, const ColorRGB& color)
+{
+    glShaderUse(shader);
+    glShaderSetFloat(shader, glShaderBuiltinSlot(shader, SHADER_SLOT_ALPHA), alpha);
+    glShaderSetVec3(shader, glShaderBuiltinSlot(shader, SHADER_SLOT_COLOR), vec3(color.r, color.g, color.b));
+    glShaderSetInt(shader, glShaderBuiltinSlot(shader, SHADER_SLOT_TEX), 0);
+}
+
+// draws the frame's texture region with the program state the caller has set up
+static void ui2dFrameQuadDraw(const UiFrame& frame, float x, float y, int shader)
+{
+    GlSprite sprite;
+    sprite.x = x;
+    sprite.y = y;
+    sprite.width = frame.width;
+    sprite.height = frame.height;
+    sprite.u0 = frame.u0;
+    sprite.v0 = frame.v0;
+    sprite.u1 = frame.u1;
+    sprite.v1 = frame.v1;
+    sprite.texture = -1;
+    sprite.shader = shader;
+
+    glSpriteBatchFlush();
+    glSpriteBatchDraw(sprite);
+    glSpriteBatchFlush();
+}
 
-    effects.blurTextureWidth = width;
-    effects.blurTextureHeight = height;
+// state an offscreen effect pass changes and puts back
+struct UiOffscreenState {
+    int framebuffer;
+    int viewport[4];
+    vec2 canvas;
+    bool blend;
+};
+
+// every pass covers its whole target and replaces what was there, so pooled targets need no clear;
+// the canvas is the frame's size so each pass draws the same quad whatever the target resolution
+static UiOffscreenState ui2dBeginOffscreen(const UiFrame& frame)
+{
+    UiOffscreenState state;
+    state.framebuffer = glStateGetFramebuffer();
+    glStateGetViewport(state.viewport);
+    state.canvas = glCanvasGetSize();
+    state.blend = glStateIsEnabled(GL_BLEND);
+
+    glCanvasSetSize(frame.width, frame.height);
+    glStateEnable(GL_BLEND, false);
+    return state;
+}
+
+static void ui2dEndOffscreen(const UiOffscreenState& state)
+{
+    glStateBindFramebuffer(state.framebuffer);
+    glStateViewport(state.viewport[0], state.viewport[1], state.viewport[2], state.viewport[3]);
+    glCanvasSetSize(state.canvas.x, state.canvas.y);
+    glStateEnable(GL_BLEND, state.blend);
+}
 
-    for (int i = 0; i < 2; ++i) {
-        glBindTexture(GL_TEXTURE_2D, effects.blurTextures[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+// a texture the library does not version, such as a render target drawn into every frame, cannot be cached from
+static bool ui2dTextureUntracked(int texture, unsigned int version)
+{
+    return texture > 0 && version == 0;
+}
 
-        glBindFramebuffer(GL_FRAMEBUFFER, effects.blurFramebuffers[i]);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, effects.blurTextures[i], 0);
+// blurred result of a frame, kept until its source texture, size or radius changes
+struct UiBlurCache {
+    GlRenderTarget target;
+    int texture = 0;
+    unsigned int textureVersion = 0;
+    float u0 = 0.0f, v0 = 0.0f, u1 = 0.0f, v1 = 0.0f;
+    int width = 0;
+    int height = 0;
+    float radius = 0.0f;
+    bool flipped = false;   // every pass into a texture flips it, so an odd pass count leaves it upside down
+};
+
+static std::unordered_map<const UiFrame*, UiBlurCache> uiBlurCaches;
+
+static void ui2dBlurCacheDrop(const UiFrame* frame)
+{
+    auto it = uiBlurCaches.find(frame);
+    if (it == uiBlurCaches.end()) {
+        return;
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glRenderTargetRelease(it->second.target);
+    uiBlurCaches.erase(it);
 }
 
-static void ui2dRunBlurPasses(UiFrame& frame, UiEffectSettings& effects, float alpha)
+// renders the blur into cache.target: large radii are first halved down a chain of smaller targets, so
+// the gaussian always runs with a radius of a few texels and on a fraction of the pixels
+static void ui2dBlurRender(const UiFrame& frame, float radius, int width, int height, UiBlurCache& cache)
 {
-    int targetWidth = std::max(1, static_cast<int>(std::round(frame.width)));
-    int targetHeight = std::max(1, static_cast<int>(std::round(frame.height)));
-    ui2dEnsureBlurTargets(effects, targetWidth, targetHeight);
+    int scale = 1;
+    while (radius / scale > UI_BLUR_RADIUS_PER_LEVEL && scale < UI_BLUR_MAX_DOWNSAMPLE) {
+        scale *= 2;
+    }
 
-    GLint prevFramebuffer = 0;
-    GLint prevViewport[4] = {0, 0, 0, 0};
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFramebuffer);
-    glGetIntegerv(GL_VIEWPORT, prevViewport);
+    UiOffscreenState state = ui2dBeginOffscreen(frame);
 
-    glUseProgram(uiBlurShader);
-    glUniform1f(glGetUniformLocation(uiBlurShader, "blurRadius"), effects.blurRadius);
-    glUniform1f(glGetUniformLocation(uiBlurShader, "alphaValue"), 1.0f);
-    glUniform3f(glGetUniformLocation(uiBlurShader, "color"), 1.0f, 1.0f, 1.0f);
-    glUniform2f(glGetUniformLocation(uiBlurShader, "targetSize"), static_cast<float>(targetWidth), static_cast<float>(targetHeight));
+    int passes = 0;
+    GlRenderTarget source;
+    int levelWidth = width;
+    int levelHeight = height;
 
-    glViewport(0, 0, targetWidth, targetHeight);
+    ui2dUseQuadShader(uiDefaultShader, 1.0f, ColorRGB(1.0f, 1.0f, 1.0f));
+    for (int level = 1; level < scale; level *= 2) {
+        levelWidth = std::max(1, (levelWidth + 1) / 2);
+        levelHeight = std::max(1, (levelHeight + 1) / 2);
+        GlRenderTarget next = glRenderTargetAcquire(levelWidth, levelHeight);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, effects.blurFramebuffers[0]);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, frame.texture);
-    glUniform1i(glGetUniformLocation(uiBlurShader, "tex"), 0);
-    glUniform2f(glGetUniformLocation(uiBlurShader, "direction"), 1.0f, 0.0f);
-    glQuadDraw(0.0f, 0.0f, frame.width, frame.height, uiBlurShader);
+        glStateBindFramebuffer(next.framebuffer);
+        glStateViewport(0, 0, levelWidth, levelHeight);
+        if (passes == 0) {
+            glStateBindTexture(0, frame.texture);
+            ui2dFrameQuadDraw(frame, 0.0f, 0.0f, uiDefaultShader);
+        } else {
+            glStateBindTexture(0, source.texture);
+            glQuadDraw(0.0f, 0.0f, frame.width, frame.height, uiDefaultShader);
+            glRenderTargetRelease(source);
+        }
+
+        source = next;
+        passes++;
+    }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, effects.blurFramebuffers[1]);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, effects.blurTextures[0]);
-    glUniform1i(glGetUniformLocation(uiBlurShader, "tex"), 0);
-    glUniform2f(glGetUniformLocation(uiBlurShader, "direction"), 0.0f, 1.0f);
+    if (cache.target.framebuffer && (cache.target.width != levelWidth || cache.target.height != levelHeight)) {
+        glRenderTargetRelease(cache.target);
+        cache.target = GlRenderTarget();
+    }
+    if (!cache.target.framebuffer) {
+        cache.target = glRenderTargetAcquire(levelWidth, levelHeight);
+    }
+    GlRenderTarget horizontal = glRenderTargetAcquire(levelWidth, levelHeight);
+    glStateViewport(0, 0, levelWidth, levelHeight);
+
+    ui2dUseQuadShader(uiBlurShader, 1.0f, ColorRGB(1.0f, 1.0f, 1.0f));
+    glShaderSetFloat(uiBlurShader, uiBlurRadiusSlot, radius / scale);
+
+    glStateBindFramebuffer(horizontal.framebuffer);
+    glShaderSetVec2(uiBlurShader, uiBlurDirectionSlot, vec2(1.0f, 0.0f));
+    if (passes == 0) {
+        glStateBindTexture(0, frame.texture);
+        ui2dFrameQuadDraw(frame, 0.0f, 0.0f, uiBlurShader);
+    } else {
+        glStateBindTexture(0, source.texture);
+        glQuadDraw(0.0f, 0.0f, frame.width, frame.height, uiBlurShader);
+        glRenderTargetRelease(source);
+    }
+
+    glStateBindFramebuffer(cache.target.framebuffer);
+    glStateBindTexture(0, horizontal.texture);
+    glShaderSetVec2(uiBlurShader, uiBlurDirectionSlot, vec2(0.0f, 1.0f));
     glQuadDraw(0.0f, 0.0f, frame.width, frame.height, uiBlurShader);
+    glRenderTargetRelease(horizontal);
+    passes += 2;
+
+    ui2dEndOffscreen(state);
+
+    cache.flipped = (passes % 2) == 1;
+}
+
+static void ui2dRunBlurPasses(UiFrame& frame, const UiEffectSettings& effects, float x, float y, float alpha)
+{
+    int width = std::max(1, static_cast<int>(std::round(frame.width)));
+    int height = std::max(1, static_cast<int>(std::round(frame.height)));
+
+    UiBlurCache& cache = uiBlurCaches[&frame];
+    unsigned int version = glTextureGetVersion(frame.texture);
+    bool valid = cache.target.framebuffer != 0 && !ui2dTextureUntracked(frame.texture, version) &&
+                 cache.texture == frame.texture && cache.textureVersion == version &&
+                 cache.u0 == frame.u0 && cache.v0 == frame.v0 && cache.u1 == frame.u1 && cache.v1 == frame.v1 &&
+                 cache.width == width && cache.height == height && cache.radius == effects.blurRadius;
+
+    if (!valid) {
+        glSpriteBatchFlush();
+        ui2dBlurRender(frame, effects.blurRadius, width, height, cache);
+        cache.texture = frame.texture;
+        cache.textureVersion = version;
+        cache.u0 = frame.u0;
+        cache.v0 = frame.v0;
+        cache.u1 = frame.u1;
+        cache.v1 = frame.v1;
+        cache.width = width;
+        cache.height = height;
+        cache.radius = effects.blurRadius;
+    }
+
+    // steady state: one textured quad, batched with its neighbours
+    GlSprite sprite;
+    sprite.x = x;
+    sprite.y = y;
+    sprite.width = frame.width;
+    sprite.height = frame.height;
+    sprite.v0 = cache.flipped ? 1.0f : 0.0f;
+    sprite.v1 = cache.flipped ? 0.0f : 1.0f;
+    sprite.tint = frame.color;
+    sprite.alpha = alpha;
+    sprite.texture = cache.target.texture;
+    glSpriteBatchDraw(sprite);
+}
+
+// baked shadow mask: white with the shadow's coverage in alpha, tinted with the shadow color when drawn.
+// frames showing the same texture region at the same size and blur share one mask
+struct UiShadowKey {
+    int texture;
+    unsigned int textureVersion;
+    float u0, v0, u1, v1;
+    int width, height;
+    float blur;
+    float offsetX, offsetY;     // inner shadows only; a drop shadow's offset just moves the quad
+    bool inner;
+
+    bool operator==(const UiShadowKey& other) const
+    {
+        return texture == other.texture && textureVersion == other.textureVersion &&
+               u0 == other.u0 && v0 == other.v0 && u1 == other.u1 && v1 == other.v1 &&
+               width == other.width && height == other.height && blur == other.blur &&
+               offsetX == other.offsetX && offsetY == other.offsetY && inner == other.inner;
+    }
+};
+
+struct UiShadowKeyHash {
+    size_t operator()(const UiShadowKey& key) const
+    {
+        size_t hash = std::hash<int>()(key.texture);
+        auto mix = [&hash](size_t value) { hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+        mix(key.textureVersion);
+        mix(std::hash<float>()(key.u0));
+        mix(std::hash<float>()(key.v0));
+        mix(std::hash<float>()(key.u1));
+        mix(std::hash<float>()(key.v1));
+        mix(static_cast<size_t>(key.width) << 16 ^ static_cast<size_t>(key.height));
+        mix(std::hash<float>()(key.blur));
+        mix(std::hash<float>()(key.offsetX));
+        mix(std::hash<float>()(key.offsetY));
+        mix(key.inner ? 1 : 0);
+        return hash;
+    }
+};
+
+struct UiShadowMask {
+    GlRenderTarget target;
+    int lastDrawn;
+};
+
+static std::unordered_map<UiShadowKey, UiShadowMask, UiShadowKeyHash> uiShadowMasks;
+
+// two separable passes of the 5-tap kernel the old per-pixel shaders ran as a 5x5 grid. The first samples the
+// frame's texture and also keeps its unblurred alpha for the inner shadow; the second works in target space
+static void ui2dShadowBake(const UiFrame& frame, const UiShadowKey& key, const GlRenderTarget& target)
+{
+    // tap spacing is in texels of the source texture, as before
+    int textureWidth = key.width, textureHeight = key.height;
+    glTextureGetSize(frame.texture, &textureWidth, &textureHeight);
+    vec2 texel(1.0f / std::max(textureWidth, 1), 1.0f / std::max(textureHeight, 1));
+    float regionHeight = std::max(std::fabs(frame.v1 - frame.v0), 1e-6f);
+
+    UiOffscreenState state = ui2dBeginOffscreen(frame);
+    GlRenderTarget horizontal = glRenderTargetAcquire(key.width, key.height);
+    glStateViewport(0, 0, key.width, key.height);
+
+    ui2dUseQuadShader(uiShadowBakeShader, 1.0f, ColorRGB(1.0f, 1.0f, 1.0f));
+    glShaderSetInt(uiShadowBakeShader, uiShadowInnerSlot, key.inner ? 1 : 0);
+
+    glStateBindFramebuffer(horizontal.framebuffer);
+    glStateBindTexture(0, frame.texture);
+    glShaderSetInt(uiShadowBakeShader, uiShadowPassSlot, 0);
+    glShaderSetVec2(uiShadowBakeShader, uiShadowStepSlot, vec2(key.blur * texel.x, 0.0f));
+    glShaderSetVec2(uiShadowBakeShader, uiShadowOffsetSlot, vec2(key.offsetX * texel.x, key.offsetY * texel.y));
+    ui2dFrameQuadDraw(frame, 0.0f, 0.0f, uiShadowBakeShader);
+
+    // the vertical step converted from source texels to the target, which spans the frame's texture region
+    glStateBindFramebuffer(target.framebuffer);
+    glStateBindTexture(0, horizontal.texture);
+    glShaderSetInt(uiShadowBakeShader, uiShadowPassSlot, 1);
+    glShaderSetVec2(uiShadowBakeShader, uiShadowStepSlot, vec2(0.0f, key.blur * texel.y / regionHeight));
+    glQuadDraw(0.0f, 0.0f, frame.width, frame.height, uiShadowBakeShader);
+
+    glRenderTargetRelease(horizontal);
+    ui2dEndOffscreen(state);
+}
 
-    glBindFramebuffer(GL_FRAMEBUFFER, prevFramebuffer);
-    glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+static void ui2dShadowDraw(const UiFrame& frame, float x, float y, float blur, float offsetX, float offsetY, bool inner, const ColorRGBA& color, float alpha)
+{
+    UiShadowKey key;
+    key.texture = frame.texture;
+    key.textureVersion = glTextureGetVersion(frame.texture);
+    key.u0 = frame.u0;
+    key.v0 = frame.v0;
+    key.u1 = frame.u1;
+    key.v1 = frame.v1;
+    key.width = std::max(1, static_cast<int>(std::round(frame.width)));
+    key.height = std::max(1, static_cast<int>(std::round(frame.height)));
+    key.blur = blur;
+    key.offsetX = inner ? offsetX : 0.0f;
+    key.offsetY = inner ? offsetY : 0.0f;
+    key.inner = inner;
+
+    auto it = uiShadowMasks.find(key);
+    if (it == uiShadowMasks.end()) {
+        glSpriteBatchFlush();
+        UiShadowMask mask;
+        mask.target = glRenderTargetAcquire(key.width, key.height);
+        ui2dShadowBake(frame, key, mask.target);
+        it = uiShadowMasks.emplace(key, mask).first;
+    } else if (ui2dTextureUntracked(frame.texture, key.textureVersion)) {
+        // nothing says when its pixels change, so the mask is baked again into the same target every frame
+        glSpriteBatchFlush();
+        ui2dShadowBake(frame, key, it->second.target);
+    }
+    it->second.lastDrawn = uiDrawCount;
+
+    // the first pass flipped the mask, the second sampled it in place
+    GlSprite sprite;
+    sprite.x = x;
+    sprite.y = y;
+    sprite.width = frame.width;
+    sprite.height = frame.height;
+    sprite.v0 = 1.0f;
+    sprite.v1 = 0.0f;
+    sprite.tint = ColorRGB(color.r, color.g, color.b);
+    sprite.alpha = color.a * alpha;
+    sprite.texture = it->second.target.texture;
+    glSpriteBatchDraw(sprite);
+}
 
-    glUseProgram(uiDefaultShader);
-    glUniform1f(glGetUniformLocation(uiDefaultShader, "alphaValue"), alpha);
-    glUniform3f(glGetUniformLocation(uiDefaultShader, "color"), frame.color.r, frame.color.g, frame.color.b);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, effects.blurTextures[1]);
-    glUniform1i(glGetUniformLocation(uiDefaultShader, "tex"), 0);
-    glQuadDraw(frame.x, frame.y, frame.width, frame.height, uiDefaultShader);
+static void ui2dShadowEvict()
+{
+    for (auto it = uiShadowMasks.begin(); it != uiShadowMasks.end();) {
+        if (uiDrawCount - it->second.lastDrawn > UI_SHADOW_IDLE_FRAMES) {
+            glRenderTargetRelease(it->second.target);
+            it = uiShadowMasks.erase(it);
+        } else {
+            ++it;
+        }
+    }
 }
 
 static void ui2dEnsureShaders()
@@ -112,15 +545,9 @@ static void ui2dEnsureShaders()
         uniform vec2 position;
         uniform vec2 scale;
 
-        #define SCREEN_WIDTH 800.0
-        #define SCREEN_HEIGHT 480.0
-
         void main() {
             vec2 scaledPos = aPos * scale;
-            vec2 screenPos = position + scaledPos;
-            vec2 ndcPos = (screenPos / vec2(SCREEN_WIDTH, SCREEN_HEIGHT)) * 2.0 - 1.0;
-            ndcPos.y = -ndcPos.y;
-            gl_Position = vec4(ndcPos, 0.0, 1.0);
+            gl_Position = glintCanvasToClip(position + scaledPos);
             TexCoord = aTexCoord;
         }
         )",
@@ -153,14 +580,10 @@ static void ui2dEnsureShaders()
 
         uniform vec2 position;
         uniform vec2 scale;
-        uniform vec2 targetSize;
 
         void main() {
             vec2 scaledPos = aPos * scale;
-            vec2 screenPos = position + scaledPos;
-            vec2 ndcPos = (screenPos / targetSize) * 2.0 - 1.0;
-            ndcPos.y = -ndcPos.y;
-            gl_Position = vec4(ndcPos, 0.0, 1.0);
+            gl_Position = glintCanvasToClip(position + scaledPos);
             TexCoord = aTexCoord;
         }
         )",
@@ -196,6 +619,7 @@ static void ui2dEnsureShaders()
             result += texture(tex, TexCoord - texel) * w1;
             result += texture(tex, TexCoord + texel * 2.0) * w2;
             result += texture(tex, TexCoord - texel * 2.0) * w2;
+            result /= w0 + 2.0 * (w1 + w2); // the truncated kernel sums to 0.86, which darkened every pass
 
             result.rgb *= color;
             result.a *= alphaValue;
@@ -204,7 +628,7 @@ static void ui2dEnsureShaders()
         )"
     );
 
-    uiShadowShader = glGenerateShader(
+    uiShadowBakeShader = glGenerateShader(
         R"(
         #version 300 es
         layout(location = 0) in vec2 aPos;
@@ -215,15 +639,9 @@ static void ui2dEnsureShaders()
         uniform vec2 position;
         uniform vec2 scale;
 
-        #define SCREEN_WIDTH 800.0
-        #define SCREEN_HEIGHT 480.0
-
         void main() {
             vec2 scaledPos = aPos * scale;
-            vec2 screenPos = position + scaledPos;
-            vec2 ndcPos = (screenPos / vec2(SCREEN_WIDTH, SCREEN_HEIGHT)) * 2.0 - 1.0;
-            ndcPos.y = -ndcPos.y;
-            gl_Position = vec4(ndcPos, 0.0, 1.0);
+            gl_Position = glintCanvasToClip(position + scaledPos);
             TexCoord = aTexCoord;
         }
         )",
@@ -233,236 +651,456 @@ static void ui2dEnsureShaders()
 
         in vec2 TexCoord;
         uniform sampler2D tex;
-        uniform float alphaValue;
-        uniform float blurRadius;
-        uniform vec4 shadowColor;
+        uniform int pass;           // 0: horizontal, from the frame's texture; 1: vertical, from pass 0's target
+        uniform bool inner;
+        uniform vec2 blurStep;      // tap spacing, in uv of the texture being sampled
+        uniform vec2 sampleOffset;  // inner shadow offset, pass 0 only
 
         out vec4 FragColor;
 
-        float blurredAlpha(vec2 uv) {
-            if (blurRadius <= 0.01) {
-                return texture(tex, uv).a;
-            }
-
-            vec2 texOffset = blurRadius * (1.0 / vec2(textureSize(tex, 0)));
+        void main() {
             float kernel[5] = float[](1.0, 4.0, 7.0, 4.0, 1.0);
             float result = 0.0;
-            float weightSum = 0.0;
-
-            for (int x = -2; x <= 2; ++x) {
-                float wx = kernel[x + 2];
-                for (int y = -2; y <= 2; ++y) {
-                    float wy = kernel[y + 2];
-                    float w = wx * wy;
-                    vec2 offset = vec2(float(x), float(y)) * texOffset;
-                    result += texture(tex, uv + offset).a * w;
-                    weightSum += w;
+
+            if (pass == 0) {
+                for (int i = -2; i <= 2; ++i) {
+                    result += texture(tex, TexCoord + sampleOffset + blurStep * float(i)).a * kernel[i + 2];
                 }
+                // red keeps the unblurred coverage for the inner shadow's subtraction
+                FragColor = vec4(texture(tex, TexCoord).a, 1.0, 1.0, result / 17.0);
+                return;
             }
 
-            return result / weightSum;
-        }
+            // same size as pass 0's target, so fragment coordinates address it directly
+            vec2 uv = gl_FragCoord.xy / vec2(textureSize(tex, 0));
+            for (int i = -2; i <= 2; ++i) {
+                result += texture(tex, uv + blurStep * float(i)).a * kernel[i + 2];
+            }
+            result /= 17.0;
 
-        void main() {
-            float a = blurredAlpha(TexCoord);
-            float outAlpha = a * shadowColor.a * alphaValue;
-            FragColor = vec4(shadowColor.rgb, outAlpha);
+            if (inner) {
+                result = clamp(result - texture(tex, uv).r, 0.0, 1.0);
+            }
+            FragColor = vec4(1.0, 1.0, 1.0, result);
         }
         )"
     );
 
-    uiInnerShadowShader = glGenerateShader(
-        R"(
-        #version 300 es
-        layout(location = 0) in vec2 aPos;
-        layout(location = 1) in vec2 aTexCoord;
+    uiBlurRadiusSlot = glShaderGetUniform(uiBlurShader, "blurRadius");
+    uiBlurDirectionSlot = glShaderGetUniform(uiBlurShader, "direction");
+    uiShadowStepSlot = glShaderGetUniform(uiShadowBakeShader, "blurStep");
+    uiShadowOffsetSlot = glShaderGetUniform(uiShadowBakeShader, "sampleOffset");
+    uiShadowPassSlot = glShaderGetUniform(uiShadowBakeShader, "pass");
+    uiShadowInnerSlot = glShaderGetUniform(uiShadowBakeShader, "inner");
+}
 
-        out vec2 TexCoord;
+static void ui2dRegisterFrame(UiFrame* frame)
+{
+    if (allFrameSet.insert(frame).second) {
+        allFrames.push_back(frame);
+        uiLayoutVersion++;
+    }
+}
 
-        uniform vec2 position;
-        uniform vec2 scale;
+// the frame tree flattened in draw order (parents before children, siblings in order) and rebuilt only when its
+// shape changes. Layout, alpha and visibility, and drawing are linear passes over these arrays; UiFrame keeps the
+// settings, and a frame's fields are only set to the resolved values around its onRender
+struct UiTree {
+    UiFrame* root = nullptr;
+    unsigned int version = ~0u;
+
+    std::vector<UiFrame*> frames;
+    std::vector<int> parent;            // -1 for the root
+    std::vector<int> subtreeEnd;        // one past the frame's last descendant
+    std::vector<int> childCount;        // children when flattened, to notice edits made to children directly
+    std::vector<UiRect> rect;           // resolved
+    std::vector<float> alpha;           // with the parents' alpha applied
+    std::vector<unsigned char> visible; // false when the frame or any parent is hidden
+    unsigned int builds = 0;            // a callback that rebuilt the tree mid-draw ends that draw pass
+
+    bool isCurrent(const UiFrame* frame) const
+    {
+        return version == uiTreeVersion && frame->treeIndex >= 0 &&
+               frame->treeIndex < static_cast<int>(frames.size()) && frames[frame->treeIndex] == frame;
+    }
 
-        #define SCREEN_WIDTH 800.0
-        #define SCREEN_HEIGHT 480.0
+    void add(UiFrame* frame, int parentIndex, bool main)
+    {
+        int index = static_cast<int>(frames.size());
+        frames.push_back(frame);
+        parent.push_back(parentIndex);
+        subtreeEnd.push_back(0);
+        childCount.push_back(static_cast<int>(frame->children.size()));
+        if (main) {
+            frame->treeIndex = index;
+        }
 
-        void main() {
-            vec2 scaledPos = aPos * scale;
-            vec2 screenPos = position + scaledPos;
-            vec2 ndcPos = (screenPos / vec2(SCREEN_WIDTH, SCREEN_HEIGHT)) * 2.0 - 1.0;
-            ndcPos.y = -ndcPos.y;
-            gl_Position = vec4(ndcPos, 0.0, 1.0);
-            TexCoord = aTexCoord;
+        for (UiFrame* child : frame->children) {
+            add(child, index, main);
         }
-        )",
-        R"(
-        #version 300 es
-        precision mediump float;
+        subtreeEnd[index] = static_cast<int>(frames.size());
+    }
 
-        in vec2 TexCoord;
-        uniform sampler2D tex;
-        uniform float alphaValue;
-        uniform float blurRadius;
-        uniform vec2 shadowOffset;
-        uniform vec4 shadowColor;
+    void build(UiFrame* newRoot, bool main)
+    {
+        root = newRoot;
+        version = uiTreeVersion;
+        builds++;
+        frames.clear();
+        parent.clear();
+        subtreeEnd.clear();
+        childCount.clear();
+        add(root, -1, main);
+
+        rect.resize(frames.size());
+        alpha.resize(frames.size());
+        visible.resize(frames.size());
+
+        // frames join the navigation registry once it exists, as they are first drawn
+        if (!allFrames.empty()) {
+            for (UiFrame* frame : frames) {
+                ui2dRegisterFrame(frame);
+            }
+        }
+    }
 
-        out vec4 FragColor;
+    bool shapeChanged() const
+    {
+        for (size_t i = 0; i < frames.size(); ++i) {
+            if (static_cast<int>(frames[i]->children.size()) != childCount[i]) {
+                return true;
+            }
+        }
+        return false;
+    }
 
-        float blurredAlpha(vec2 uv) {
-            if (blurRadius <= 0.01) {
-                return texture(tex, uv).a;
+    void update(UiFrame* newRoot, bool main)
+    {
+        if (root != newRoot || version != uiTreeVersion || shapeChanged()) {
+            if (version == uiTreeVersion) {
+                uiTreeVersion++;
             }
+            build(newRoot, main);
+        }
 
-            vec2 texOffset = blurRadius * (1.0 / vec2(textureSize(tex, 0)));
-            float kernel[5] = float[](1.0, 4.0, 7.0, 4.0, 1.0);
-            float result = 0.0;
-            float weightSum = 0.0;
-
-            for (int x = -2; x <= 2; ++x) {
-                float wx = kernel[x + 2];
-                for (int y = -2; y <= 2; ++y) {
-                    float wy = kernel[y + 2];
-                    float w = wx * wy;
-                    vec2 offset = vec2(float(x), float(y)) * texOffset;
-                    result += texture(tex, uv + offset).a * w;
-                    weightSum += w;
-                }
+        // children before parents, so a resize reaches the parent's auto size and placement in the same update
+        for (int i = static_cast<int>(frames.size()) - 1; i >= 0; --i) {
+            if (frames[i]->layoutCheck() && parent[i] >= 0) {
+                frames[parent[i]]->layoutDirty = true;
             }
+        }
 
-            return result / weightSum;
+        if (root->layoutX != root->x || root->layoutY != root->y) {
+            root->layoutX = root->x;
+            root->layoutY = root->y;
+            root->layoutDirty = true;
+            uiLayoutVersion++;
         }
 
-        void main() {
-            vec2 texel = 1.0 / vec2(textureSize(tex, 0));
-            vec2 offset = shadowOffset * texel;
-            float baseAlpha = texture(tex, TexCoord).a;
-            float blurred = blurredAlpha(TexCoord + offset);
-            float inner = clamp(blurred - baseAlpha, 0.0, 1.0);
-            float outAlpha = inner * shadowColor.a * alphaValue;
-            FragColor = vec4(shadowColor.rgb, outAlpha);
+        for (UiFrame* frame : frames) {
+            frame->layoutArrange();
         }
-        )"
-    );
-}
+    }
 
-void ui2dInit()
-{
+    void resolve()
+    {
+        for (size_t i = 0; i < frames.size(); ++i) {
+            const UiFrame& frame = *frames[i];
+            int p = parent[i];
+            rect[i] = frame.getResolvedRect();
+            alpha[i] = frame.forceAlpha ? frame.alpha : frame.alpha * (p >= 0 ? alpha[p] : 1.0f);
+            visible[i] = frame.visible && (p < 0 || visible[p]);
+        }
+    }
 
-    ui2dEnsureShaders();
-    mainFrame = ui2dAddFrame(0, 0, 800, 480);
+    void drawFrame(int index)
+    {
+        UiFrame& frame = *frames[index];
+        float x = rect[index].x;
+        float y = rect[index].y;
+        float frameAlpha = alpha[index];
 
-    ioDebugPrint("Initializing 2D UI system\n");
+        const UiEffectSettings& effects = frame.effectSettings;
+        bool hasTexture = frame.texture >= 0;
+        bool hasExplicitRender = (frame.onRender != nullptr) || hasTexture || (frame.shader != -1);
 
-}
+        if (!(effects.blurEnabled && hasTexture) && !uiBlurCaches.empty()) {
+            ui2dBlurCacheDrop(&frame);
+        }
 
-// spatial neighbor navigation for UI selection
-void navigateUI(int direction) {
-    // direction: 0 = up, 1 = down, 2 = left, 3 = right
-    /*
-    
-    // Moving RIGHT: B's left edge must be to the right of A's center
-    bool isRight = B.x > (A.x + A.width / 2)
+        if (effects.dropShadowEnabled && hasTexture) {
+            ui2dShadowDraw(frame, x + effects.dropShadowOffsetX, y + effects.dropShadowOffsetY, effects.dropShadowBlur,
+                           0.0f, 0.0f, false, effects.dropShadowColor, frameAlpha);
+        }
 
-    // Moving LEFT: B's right edge must be left of A's center  
-    bool isLeft = (B.x + B.width) < (A.x + A.width / 2)
+        if (frame.onRender) {
+            glSpriteBatchFlush();
+            int shaderToUse = (frame.shader != -1) ? frame.shader : uiDefaultShader;
+            ui2dUseQuadShader(shaderToUse, frameAlpha, frame.color);
+
+            glStateBindTexture(0, frame.texture);
+
+            // callbacks read the frame, so it shows its resolved position and alpha while they run
+            float px = frame.x;
+            float py = frame.y;
+            float pa = frame.alpha;
+            frame.x = x;
+            frame.y = y;
+            frame.alpha = frameAlpha;
+
+            frame.onRender(frame);
+
+            frame.x = px;
+            frame.y = py;
+            frame.alpha = pa;
+        } else if (hasExplicitRender) {
+            if (effects.blurEnabled && hasTexture) {
+                ui2dRunBlurPasses(frame, effects, x, y, frameAlpha);
+            } else if (frame.shader == -1 && hasTexture) {
+                // plain textured quad: let the sprite batch merge it with its neighbours
+                GlSprite sprite;
+                sprite.x = x;
+                sprite.y = y;
+                sprite.width = frame.width;
+                sprite.height = frame.height;
+                sprite.tint = frame.color;
+                sprite.alpha = frameAlpha;
+                sprite.texture = frame.texture;
+                sprite.u0 = frame.u0;
+                sprite.v0 = frame.v0;
+                sprite.u1 = frame.u1;
+                sprite.v1 = frame.v1;
+                glSpriteBatchDraw(sprite);
+            } else {
+                glSpriteBatchFlush();
+                int shaderToUse = (frame.shader != -1) ? frame.shader : uiDefaultShader;
+                ui2dUseQuadShader(shaderToUse, frameAlpha, frame.color);
+
+                glStateBindTexture(0, frame.texture);
+
+                ui2dFrameQuadDraw(frame, x, y, shaderToUse);
+            }
+        }
 
-    // Similar for up/down using y axis
+        if (effects.innerShadowEnabled && hasTexture) {
+            ui2dShadowDraw(frame, x, y, effects.innerShadowBlur, effects.innerShadowOffsetX, effects.innerShadowOffsetY,
+                           true, effects.innerShadowColor, frameAlpha);
+        }
+    }
 
-    primaryDist   = distance along the axis you're moving (prefer closer)
-    secondaryDist = distance along the perpendicular axis (prefer aligned)
+    void draw(int begin, int end)
+    {
+        unsigned int startBuilds = builds;
+        for (int i = begin; i < end && builds == startBuilds;) {
+            // a hidden frame hides everything under it, as does one destroyed earlier in this pass
+            if (!visible[i] || frames[i]->destroyed) {
+                i = subtreeEnd[i];
+                continue;
+            }
 
-    score = primaryDist + (secondaryDist * weight)  // weight ~2.0-3.0
+            drawFrame(i);
+            ++i;
+        }
+    }
+};
 
-    function navigate(focused, direction, allElements):
-        candidates = filter elements by:
-            - not focused itself
-            - not disabled/hidden
-            - is in the correct direction from focused
+static UiTree uiTree;
 
-        if candidates is empty:
-            return focused  // or wrap around
+void ui2dInit()
+{
 
-        return min(candidates, by score)
-    */
+    ui2dEnsureShaders();
 
-    if (!selectedFrame) {
-        selectedFrame = allFrames.empty() ? nullptr : allFrames[0];
-        return;
+    // a fresh tree; the old one goes back to the pool
+    if (mainFrame) {
+        UiFrame* previous = mainFrame;
+        mainFrame = nullptr;
+        ui2dDestroyFrame(*previous);
     }
+    ui2dRootFrame();
 
-    mainFrame.applyLayout();
-
-    std::vector<UiFrame*> candidates;
-    for (UiFrame* frame : allFrames) {
+    ioDebugPrint("Initializing 2D UI system\n");
 
-        if (frame == selectedFrame) continue;
-        if (!frame->isSelectable()) continue;
+}
 
-        if (direction == 0) { // up
-            if (frame->y + frame->height <= selectedFrame->y) {
-                // candidate for up
-                candidates.push_back(frame);
-            }
-        } else if (direction == 1) { // down
-            if (frame->y >= selectedFrame->y + selectedFrame->height) {
-                // candidate for down
-                candidates.push_back(frame);
-            }
-        } else if (direction == 2) { // left
-            if (frame->x + frame->width <= selectedFrame->x) {
-                // candidate for left
-                candidates.push_back(frame);
-            }
-        } else if (direction == 3) { // right
-            if (frame->x >= selectedFrame->x + selectedFrame->width) {
-                // candidate for right
-                candidates.push_back(frame);
-            }
-        }
+struct UiNavEntry {
+    UiFrame* frame;
+    UiRect rect;
+    int order;      // position in allFrames
+};
+
+// uniform grid over the selectable frames, each filed under the cell holding its top left corner, which is the
+// point navigation measures from. Neighbours found from it are kept until the layout changes
+struct UiNavIndex {
+    unsigned int version = ~0u;
+    float originX = 0.0f, originY = 0.0f;
+    float cellSize = UI_NAV_CELL_SIZE;
+    int columns = 0, rows = 0;
+    std::vector<UiNavEntry> entries;
+    std::vector<std::vector<int>> cells;
+    std::unordered_map<const UiFrame*, std::array<UiFrame*, 4>> neighbours;    // nullptr: nothing that way
+};
+
+static UiNavIndex uiNavIndex;
+
+static void ui2dNavIndexBuild()
+{
+    UiNavIndex& index = uiNavIndex;
+    index.version = uiLayoutVersion;
+    index.entries.clear();
+    index.neighbours.clear();
+
+    float minX = std::numeric_limits<float>::max(), minY = std::numeric_limits<float>::max();
+    float maxX = std::numeric_limits<float>::lowest(), maxY = std::numeric_limits<float>::lowest();
+    for (size_t i = 0; i < allFrames.size(); ++i) {
+        if (!allFrames[i]->isSelectable()) continue;
+
+        UiRect rect = allFrames[i]->getResolvedRect();
+        index.entries.push_back({allFrames[i], rect, static_cast<int>(i)});
+        minX = std::min(minX, rect.x);
+        minY = std::min(minY, rect.y);
+        maxX = std::max(maxX, rect.x);
+        maxY = std::max(maxY, rect.y);
+    }
 
+    index.cells.clear();
+    if (index.entries.empty()) {
+        index.columns = index.rows = 0;
+        return;
     }
 
-    mainFrame.revertLayout();
+    float extent = std::max(maxX - minX, maxY - minY);
+    index.cellSize = std::max(UI_NAV_CELL_SIZE, extent / (UI_NAV_MAX_CELLS - 1));
+    index.originX = minX;
+    index.originY = minY;
+    index.columns = static_cast<int>((maxX - minX) / index.cellSize) + 1;
+    index.rows = static_cast<int>((maxY - minY) / index.cellSize) + 1;
+    index.cells.resize(static_cast<size_t>(index.columns) * index.rows);
+
+    for (size_t i = 0; i < index.entries.size(); ++i) {
+        const UiRect& rect = index.entries[i].rect;
+        int column = std::min(index.columns - 1, static_cast<int>((rect.x - minX) / index.cellSize));
+        int row = std::min(index.rows - 1, static_cast<int>((rect.y - minY) / index.cellSize));
+        index.cells[row * index.columns + column].push_back(static_cast<int>(i));
+    }
+}
 
-    if (candidates.empty()) {
-        return; // no candidates, do nothing
+// best scoring selectable frame in a direction, the same pick a scan over every frame would make. Bands of cells
+// are visited outward from the selection and the search stops once a band cannot hold anything closer
+static UiFrame* ui2dNavSearch(const UiFrame* from, int direction)
+{
+    const UiNavIndex& index = uiNavIndex;
+    if (index.entries.empty()) {
+        return nullptr;
     }
 
-    mainFrame.revertLayout();
+    UiRect selected = from->getResolvedRect();
+    bool vertical = direction == 0 || direction == 1;
+    int bands = vertical ? index.rows : index.columns;
+    int across = vertical ? index.columns : index.rows;
+    float origin = vertical ? index.originY : index.originX;
+    float start = vertical ? selected.y : selected.x;
+    float size = vertical ? selected.height : selected.width;
+
+    // candidates going down (right) start at or past the far edge; going up (left) their corner is before ours
+    bool forward = direction == 1 || direction == 3;
+    int first = static_cast<int>(std::floor(((forward ? start + size : start) - origin) / index.cellSize));
+    first = std::min(std::max(first, 0), bands - 1);
+    if (forward && start + size - origin >= bands * index.cellSize) {
+        return nullptr;
+    }
+    if (!forward && start < origin) {
+        return nullptr;
+    }
 
-    UiFrame* bestCandidate = nullptr;
+    UiFrame* best = nullptr;
     float bestScore = std::numeric_limits<float>::max();
+    int bestOrder = 0;
+
+    for (int band = first; band >= 0 && band < bands; band += forward ? 1 : -1) {
+        // closest a corner in this band can be along the direction of travel
+        float bandStart = origin + band * index.cellSize;
+        float nearest = forward ? bandStart - start : start - (bandStart + index.cellSize);
+        if (best && nearest > bestScore) {
+            break;
+        }
 
-    for (UiFrame* candidate : candidates) {
+        for (int other = 0; other < across; ++other) {
+            int cell = vertical ? band * index.columns + other : other * index.columns + band;
+            for (int entryIndex : index.cells[cell]) {
+                const UiNavEntry& entry = index.entries[entryIndex];
+                const UiRect& rect = entry.rect;
+                if (entry.frame == from) continue;
+
+                bool inDirection = false;
+                if (direction == 0) { // up
+                    inDirection = rect.y + rect.height <= selected.y;
+                } else if (direction == 1) { // down
+                    inDirection = rect.y >= selected.y + selected.height;
+                } else if (direction == 2) { // left
+                    inDirection = rect.x + rect.width <= selected.x;
+                } else if (direction == 3) { // right
+                    inDirection = rect.x >= selected.x + selected.width;
+                }
 
-        float primaryDist, secondaryDist;
+                if (!inDirection) continue;
 
-        if (direction == 0 || direction == 1) { // up or down
-            primaryDist = std::abs(candidate->y - selectedFrame->y);
-            secondaryDist = std::abs((candidate->x + candidate->width / 2) - (selectedFrame->x + selectedFrame->width / 2));
-        } else { // left or right
-            primaryDist = std::abs(candidate->x - selectedFrame->x);
-            secondaryDist = std::abs((candidate->y + candidate->height / 2) - (selectedFrame->y + selectedFrame->height / 2));
-        }
+                float primaryDist, secondaryDist;
 
-        float score = primaryDist + (secondaryDist * 2.0f); // weight of 2.0 for secondary distance
+                if (vertical) {
+                    primaryDist = std::abs(rect.y - selected.y);
+                    secondaryDist = std::abs((rect.x + rect.width / 2) - (selected.x + selected.width / 2));
+                } else {
+                    primaryDist = std::abs(rect.x - selected.x);
+                    secondaryDist = std::abs((rect.y + rect.height / 2) - (selected.y + selected.height / 2));
+                }
+
+                float score = primaryDist + (secondaryDist * 2.0f); // weight of 2.0 for secondary distance
 
-        if (score < bestScore) {
-            bestScore = score;
-            bestCandidate = candidate;
+                // ties go to the earlier registered frame, as in a scan of allFrames
+                if (score < bestScore || (score == bestScore && best && entry.order < bestOrder)) {
+                    bestScore = score;
+                    best = entry.frame;
+                    bestOrder = entry.order;
+                }
+            }
         }
+    }
 
+    return best;
+}
+
+// spatial neighbor navigation for UI selection
+void navigateUI(int direction) {
+    // direction: 0 = up, 1 = down, 2 = left, 3 = right
+
+    if (!selectedFrame) {
+        selectedFrame = allFrames.empty() ? nullptr : allFrames[0];
+        return;
+    }
+
+    // layout was brought up to date by ui2dUpdate, so the resolved rects are this frame's
+    if (uiNavIndex.version != uiLayoutVersion) {
+        ui2dNavIndexBuild();
     }
 
-    mainFrame.revertLayout();
+    auto it = uiNavIndex.neighbours.find(selectedFrame);
+    if (it == uiNavIndex.neighbours.end()) {
+        it = uiNavIndex.neighbours.emplace(selectedFrame, std::array<UiFrame*, 4>()).first;
+        for (int i = 0; i < 4; ++i) {
+            it->second[i] = ui2dNavSearch(selectedFrame, i);
+        }
+    }
 
-    if (bestCandidate) {
-        selectedFrame = bestCandidate;
+    if (UiFrame* next = it->second[direction]) {
+        selectedFrame = next;
     }
 }
 
 void ui2dUpdate()
 {
-    mainFrame.calculateAutoSize();
+    ui2dBeginCallbacks();
+    ui2dRootFrame()->updateLayout();
 
     if (hidIsButtonPressed(GLFW_KEY_UP)) {
         navigateUI(0);
@@ -477,39 +1115,148 @@ void ui2dUpdate()
             selectedFrame->onClick(*selectedFrame);
         }
     }
+    ui2dEndCallbacks();
 }
 
 void ui2dDraw()
 {
 
-    mainFrame.draw_internal();
+    ui2dBeginCallbacks();
+    uiDrawCount++;
+    ui2dRootFrame()->updateLayout();
+    uiTree.resolve();
+    mainFrame->draw_internal();
+    glSpriteBatchFlush();
+    ui2dShadowEvict();
+    ui2dEndCallbacks();
 }
 
 UiFrame &ui2dGetMainFrame()
 {
-    return mainFrame;
+    return *ui2dRootFrame();
 }
 UiFrame &ui2dAddFrame(float x, float y, float width, float height)
 {
-    UiFrame* frame = new UiFrame();
+    UiFrame* root = ui2dRootFrame();
+    UiFrame* frame = UiFramePool::allocate();
     frame->x = x;
     frame->y = y;
     frame->width = width;
     frame->height = height;
 
 
-    frame->setParent(mainFrame);
+    frame->setParent(*root);
+
+    return *frame;
 
-    return *mainFrame.children.back();
+}
+
+void ui2dDestroyFrame(UiFrame& frame)
+{
+    if (&frame == mainFrame) {
+        ioDebugPrint("Cannot destroy the main frame, make another frame the main frame first\n");
+        return;
+    }
+
+    UiFramePool::detach(frame);
+    uiTreeVersion++;
+
+    // children go with their parent
+    std::vector<UiFrame*> doomed;
+    std::vector<UiFrame*> pending(1, &frame);
+    while (!pending.empty()) {
+        UiFrame* next = pending.back();
+        pending.pop_back();
+        doomed.push_back(next);
+        pending.insert(pending.end(), next->children.begin(), next->children.end());
+    }
+
+    std::unordered_set<UiFrame*> doomedSet(doomed.begin(), doomed.end());
+    if (doomedSet.count(selectedFrame)) {
+        selectedFrame = nullptr;
+    }
+
+    bool registered = false;
+    for (UiFrame* dead : doomed) {
+        registered |= allFrameSet.erase(dead) > 0;
+        ui2dBlurCacheDrop(dead);
+    }
+    if (registered) {
+        allFrames.erase(std::remove_if(allFrames.begin(), allFrames.end(),
+                                       [&doomedSet](UiFrame* f) { return doomedSet.count(f) > 0; }),
+                        allFrames.end());
+    }
+    uiLayoutVersion++;
+
+    // frames the caller owns are only unlinked
+    for (UiFrame* dead : doomed) {
+        dead->children.clear();
+        dead->parent = nullptr;
+        bool pooled = UiFramePool::retire(*dead);
+        if (uiCallbackDepth > 0) {
+            // a callback may be running on this frame, and the draw pass still lists it
+            UiFramePool::setDestroyed(*dead, true);
+            uiRetiredFrames.emplace_back(dead, pooled);
+        } else if (pooled) {
+            UiFramePool::recycle(*dead);
+        }
+    }
+}
+
+UiFrameHandle ui2dGetFrameHandle(const UiFrame& frame)
+{
+    UiFrameHandle handle;
+    if (UiFrameSlot* entry = UiFramePool::slotOf(frame)) {
+        handle.index = UiFramePool::indexOf(frame);
+        handle.generation = entry->generation;
+    }
+    return handle;
+}
+
+UiFrame* ui2dGetFrame(UiFrameHandle handle)
+{
+    if (handle.generation == 0 || handle.index >= UiFramePool::slotCount) {
+        return nullptr;
+    }
+
+    UiFrameSlot& entry = UiFramePool::slot(handle.index);
+    return (entry.live && entry.generation == handle.generation) ? &entry.frame : nullptr;
+}
+UiFrame* ui2dHitTest(float x, float y)
+{
+    ui2dRootFrame()->updateLayout();
+    uiTree.resolve();
 
+    // the last frame drawn at the point is the one on top
+    for (int i = static_cast<int>(uiTree.frames.size()) - 1; i >= 0; --i) {
+        if (uiTree.visible[i] && uiTree.rect[i].contains(x, y)) {
+            return uiTree.frames[i];
+        }
+    }
+    return nullptr;
 }
+
 void UiFrame::setAsMainFrame()
 {
-    mainFrame = *this;
+    // the tree is used in place: frames added from now on become children of this one
+    UiFrame* previous = mainFrame;
+    UiFramePool::detach(*this);
+
+    mainFrame = this;
+    layoutDirty = true;
+    uiTreeVersion++;
     selectedFrame = nullptr;
 
+    // a pooled root, such as the one ui2dInit makes, would be unreachable from here on
+    if (previous && previous != this && UiFramePool::slotOf(*previous)) {
+        ui2dDestroyFrame(*previous);
+    }
+
     allFrames.clear();
-    allFrames = getAllFrames();
+    allFrameSet.clear();
+    for (UiFrame* frame : getAllFrames()) {
+        ui2dRegisterFrame(frame);
+    }
 }
 
 bool UiFrame::isSelected()
@@ -523,270 +1270,247 @@ void UiFrame::select()
 }
 void UiFrame::draw_internal()
 {
-    if (!allFrames.empty() && std::find(allFrames.begin(), allFrames.end(), this) == allFrames.end()) {
-        allFrames.push_back(this);
+    if (uiTree.isCurrent(this)) {
+        uiTree.draw(treeIndex, uiTree.subtreeEnd[treeIndex]);
+        return;
     }
 
-    std::tuple<float,float> layoutPos = getLayoutPosition();
-
-    float px = x;
-    float py = y;
-    float pa = alpha;
-    bool pv = visible;
+    // a frame outside the main tree: flatten just its subtree
+    UiTree tree;
+    tree.update(this, false);
+    tree.resolve();
+    tree.draw(0, static_cast<int>(tree.frames.size()));
+}
 
-    x += std::get<0>(layoutPos);
-    y += std::get<1>(layoutPos);
-    alpha *= parent ? parent->alpha : 1.0f;
-    visible = pv && (parent ? parent->visible : true);
+static bool ui2dLayoutSettingsEqual(const UiLayoutSettings& a, const UiLayoutSettings& b)
+{
+    return a.type == b.type && a.alignmentX == b.alignmentX && a.alignmentY == b.alignmentY &&
+           a.columns == b.columns && a.rows == b.rows && a.spacingX == b.spacingX && a.spacingY == b.spacingY &&
+           a.paddingLeft == b.paddingLeft && a.paddingRight == b.paddingRight &&
+           a.paddingTop == b.paddingTop && a.paddingBottom == b.paddingBottom &&
+           a.autoSizeWidth == b.autoSizeWidth && a.autoSizeHeight == b.autoSizeHeight &&
+           a.relativeChildren == b.relativeChildren;
+}
 
-    if (forceAlpha) {
-        alpha = pa;
+// run children first: notices frames whose fields were changed since the last update and redoes auto sizes where
+// the children changed. Returns true when this frame moved or resized, which means its parent has to place it again
+bool UiFrame::layoutCheck()
+{
+    if (layoutSeenChildren != children.size() || !ui2dLayoutSettingsEqual(layoutSeenSettings, layoutSettings)) {
+        layoutSeenChildren = children.size();
+        layoutSeenSettings = layoutSettings;
+        layoutDirty = true;
     }
 
-    const UiEffectSettings& effects = effectSettings;
-    bool hasTexture = texture >= 0;
-    bool hasExplicitRender = (onRender != nullptr) || hasTexture || (shader != -1);
-
-    if (visible && effects.dropShadowEnabled && hasTexture) {
-        glUseProgram(uiShadowShader);
-        glUniform1f(glGetUniformLocation(uiShadowShader, "alphaValue"), alpha);
-        glUniform1f(glGetUniformLocation(uiShadowShader, "blurRadius"), effects.dropShadowBlur);
-        glUniform4f(glGetUniformLocation(uiShadowShader, "shadowColor"),
-            effects.dropShadowColor.r,
-            effects.dropShadowColor.g,
-            effects.dropShadowColor.b,
-            effects.dropShadowColor.a);
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glUniform1i(glGetUniformLocation(uiShadowShader, "tex"), 0);
+    const auto& ls = layoutSettings;
+    if (layoutDirty && (ls.autoSizeWidth || ls.autoSizeHeight) && ls.type != UiLayoutSettings::None &&
+        !(ls.type == UiLayoutSettings::Grid && (ls.columns <= 0 || ls.rows <= 0))) {
 
-        glQuadDraw(x + effects.dropShadowOffsetX, y + effects.dropShadowOffsetY, width, height, uiShadowShader);
-    }
+        float contentWidth  = 0;
+        float contentHeight = 0;
 
-    if (visible && this->onRender) {
-        int shaderToUse = (shader != -1) ? shader : uiDefaultShader;
-        glUseProgram(shaderToUse);
-        glUniform1f(glGetUniformLocation(shaderToUse, "alphaValue"), alpha);
-        glUniform3f(glGetUniformLocation(shaderToUse, "color"), color.r, color.g, color.b);
+        if (ls.type == UiLayoutSettings::Vertical) {
+            for (UiFrame* child : children) {
+                contentWidth   = std::max(contentWidth, child->width);
+                contentHeight += child->height + ls.spacingY;
+            }
+            if (!children.empty()) contentHeight -= ls.spacingY; // remove trailing
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glUniform1i(glGetUniformLocation(shaderToUse, "tex"), 0);
+        } else if (ls.type == UiLayoutSettings::Horizontal) {
+            for (UiFrame* child : children) {
+                contentWidth  += child->width + ls.spacingX;
+                contentHeight  = std::max(contentHeight, child->height);
+            }
+            if (!children.empty()) contentWidth -= ls.spacingX;
+
+        } else if (ls.type == UiLayoutSettings::Grid) {
+            // find the largest cell
+            float maxCellW = 0, maxCellH = 0;
+            for (UiFrame* child : children) {
+                maxCellW = std::max(maxCellW, child->width);
+                maxCellH = std::max(maxCellH, child->height);
+            }
 
-        this->onRender(*this);
-    } else if (visible && hasExplicitRender) {
-        if (effects.blurEnabled && hasTexture) {
-            ui2dRunBlurPasses(*this, effectSettings, alpha);
-        } else {
-            int shaderToUse = (shader != -1) ? shader : uiDefaultShader;
-            glUseProgram(shaderToUse);
-            glUniform1f(glGetUniformLocation(shaderToUse, "alphaValue"), alpha);
-            glUniform3f(glGetUniformLocation(shaderToUse, "color"), color.r, color.g, color.b);
+            contentWidth  = ls.columns * maxCellW + ls.spacingX * (ls.columns - 1);
+            contentHeight = ls.rows    * maxCellH + ls.spacingY * (ls.rows    - 1);
+        }
 
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, texture);
-            glUniform1i(glGetUniformLocation(shaderToUse, "tex"), 0);
+        if (ls.autoSizeWidth)
+            width  = contentWidth  + ls.paddingLeft + ls.paddingRight;
 
-            glQuadDraw(x, y, width, height, shaderToUse);
+        if (ls.autoSizeHeight) {
+            height = contentHeight + ls.paddingTop  + ls.paddingBottom;
         }
     }
 
-    if (visible && effects.innerShadowEnabled && hasTexture) {
-        glUseProgram(uiInnerShadowShader);
-        glUniform1f(glGetUniformLocation(uiInnerShadowShader, "alphaValue"), alpha);
-        glUniform1f(glGetUniformLocation(uiInnerShadowShader, "blurRadius"), effects.innerShadowBlur);
-        glUniform2f(glGetUniformLocation(uiInnerShadowShader, "shadowOffset"),
-            effects.innerShadowOffsetX,
-            effects.innerShadowOffsetY);
-        glUniform4f(glGetUniformLocation(uiInnerShadowShader, "shadowColor"),
-            effects.innerShadowColor.r,
-            effects.innerShadowColor.g,
-            effects.innerShadowColor.b,
-            effects.innerShadowColor.a);
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glUniform1i(glGetUniformLocation(uiInnerShadowShader, "tex"), 0);
-        glQuadDraw(x, y, width, height, uiInnerShadowShader);
+    bool moved = layoutSeen[0] != x || layoutSeen[1] != y;
+    bool resized = layoutSeen[2] != width || layoutSeen[3] != height;
+    if (resized) {
+        // alignment and grid cells depend on this frame's size
+        layoutDirty = true;
+        uiLayoutVersion++;
     }
 
-    for (UiFrame* child : children) {
-        child->draw_internal();
+    if (layoutSeenSelectable != isSelectable()) {
+        layoutSeenSelectable = !layoutSeenSelectable;
+        uiLayoutVersion++;
     }
 
-
-    x = px;
-    y = py;
-    alpha = pa;
-    visible = pv;
+    layoutSeen[0] = x;
+    layoutSeen[1] = y;
+    layoutSeen[2] = width;
+    layoutSeen[3] = height;
+    return moved || resized;
 }
 
-std::tuple<float, float> UiFrame::getLayoutPosition()
+// run parents first: places the children of a dirty container in one pass over them; a child that moved is marked
+// dirty so its own children follow
+void UiFrame::layoutArrange()
 {
+    if (layoutDirty) {
+        const auto& ls = layoutSettings;
+        float px = layoutX;
+        float py = layoutY;
 
-    float px = parent->x;
-    float py = parent->y;
-
-
-    if (parent == nullptr || parent->layoutSettings.type == UiLayoutSettings::None) {
-
-        if (parent && parent->layoutSettings.relativeChildren) {
-            return std::make_tuple(px, py);
+        float totalWidth = 0;
+        float totalHeight = 0;
+        for (UiFrame* child : children) {
+            totalWidth += child->width + ls.spacingX;
+            totalHeight += child->height + ls.spacingY;
         }
+        totalWidth -= ls.spacingX; // remove trailing spacing
+        totalHeight -= ls.spacingY;
 
-        return std::make_tuple(0, 0);
-    }
-
-
-    const auto& ls = parent->layoutSettings;
+        float cellWidth = 0, cellHeight = 0;
+        if (ls.type == UiLayoutSettings::Grid && ls.columns > 0 && ls.rows > 0) {
+            float availableWidth  = width  - ls.paddingLeft - ls.paddingRight;
+            float availableHeight = height - ls.paddingTop  - ls.paddingBottom;
 
-    // layout
-    if (ls.type == UiLayoutSettings::Grid) {
-        if (ls.columns <= 0 || ls.rows <= 0) {
-            return std::make_tuple(px, py);
+            cellWidth  = (availableWidth  - ls.spacingX * (ls.columns - 1)) / ls.columns;
+            cellHeight = (availableHeight - ls.spacingY * (ls.rows    - 1)) / ls.rows;
         }
 
+        // running offset of the next child along a vertical or horizontal layout
+        float along = 0;
         int index = 0;
-        for (UiFrame* child : parent->children) {
-            if (child == this) break;
-            index++;
-        }
 
-        int col = index % ls.columns;
-        int row = index / ls.columns;
+        for (UiFrame* child : children) {
+            float cx = px;
+            float cy = py;
 
-        float availableWidth  = parent->width  - ls.paddingLeft - ls.paddingRight;
-        float availableHeight = parent->height - ls.paddingTop  - ls.paddingBottom;
+            if (ls.type == UiLayoutSettings::None) {
+                if (!ls.relativeChildren) {
+                    cx = 0;
+                    cy = 0;
+                }
 
-        float cellWidth  = (availableWidth  - ls.spacingX * (ls.columns - 1)) / ls.columns;
-        float cellHeight = (availableHeight - ls.spacingY * (ls.rows    - 1)) / ls.rows;
+            } else if (ls.type == UiLayoutSettings::Grid) {
+                if (ls.columns > 0 && ls.rows > 0) {
+                    int col = index % ls.columns;
+                    int row = index / ls.columns;
 
-        px += ls.paddingLeft + col * (cellWidth  + ls.spacingX);
-        py += ls.paddingTop  + row * (cellHeight + ls.spacingY);
+                    cx += ls.paddingLeft + col * (cellWidth  + ls.spacingX);
+                    cy += ls.paddingTop  + row * (cellHeight + ls.spacingY);
 
-        // alignment within cell
-        if (ls.alignmentX == UiLayoutSettings::Center)
-            px += (cellWidth - width) / 2.0f;
-        else if (ls.alignmentX == UiLayoutSettings::End)
-            px += cellWidth - width;
+                    // alignment within cell
+                    if (ls.alignmentX == UiLayoutSettings::Center)
+                        cx += (cellWidth - child->width) / 2.0f;
+                    else if (ls.alignmentX == UiLayoutSettings::End)
+                        cx += cellWidth - child->width;
 
-        if (ls.alignmentY == UiLayoutSettings::Center)
-            py += (cellHeight - height) / 2.0f;
-        else if (ls.alignmentY == UiLayoutSettings::End)
-            py += cellHeight - height;
+                    if (ls.alignmentY == UiLayoutSettings::Center)
+                        cy += (cellHeight - child->height) / 2.0f;
+                    else if (ls.alignmentY == UiLayoutSettings::End)
+                        cy += cellHeight - child->height;
+                }
 
-    } else if (ls.type == UiLayoutSettings::Vertical) {
-    py += ls.paddingTop;
+            } else if (ls.type == UiLayoutSettings::Vertical) {
+                cy += ls.paddingTop + along;
+                along += child->height + ls.spacingY;
 
-    for (UiFrame* child : parent->children) {
-        if (child == this) break;
-        py += child->height + ls.spacingY;
-    }
+                if (ls.alignmentX == UiLayoutSettings::Start) {
+                    cx += ls.paddingLeft;
+                } else if (ls.alignmentX == UiLayoutSettings::Center) {
+                    cx += (width - child->width) / 2.0f;
+                } else if (ls.alignmentX == UiLayoutSettings::End) {
+                    cx += width - child->width - ls.paddingRight;
+                }
 
-    if (ls.alignmentX == UiLayoutSettings::Start) {
-        px += ls.paddingLeft;
-    } else if (ls.alignmentX == UiLayoutSettings::Center) {
-        px += (parent->width - width) / 2.0f;
-    } else if (ls.alignmentX == UiLayoutSettings::End) {
-        px += parent->width - width - ls.paddingRight;
-    }
+                if (ls.alignmentY == UiLayoutSettings::Center) {
+                    cy += (height - ls.paddingTop - ls.paddingBottom - totalHeight) / 2.0f;
+                } else if (ls.alignmentY == UiLayoutSettings::End) {
+                    cy += (height - ls.paddingTop - ls.paddingBottom - totalHeight);
+                }
 
-    // missing: y alignment of the whole block within parent
-    float totalHeight = 0;
-    for (UiFrame* child : parent->children) {
-        totalHeight += child->height + ls.spacingY;
-    }
-    totalHeight -= ls.spacingY; // remove trailing spacing
+            } else if (ls.type == UiLayoutSettings::Horizontal) {
+                cx += ls.paddingLeft + along;
+                along += child->width + ls.spacingX;
 
-    if (ls.alignmentY == UiLayoutSettings::Center) {
-        py += (parent->height - ls.paddingTop - ls.paddingBottom - totalHeight) / 2.0f;
-    } else if (ls.alignmentY == UiLayoutSettings::End) {
-        py += (parent->height - ls.paddingTop - ls.paddingBottom - totalHeight);
-    }
+                if (ls.alignmentY == UiLayoutSettings::Start) {
+                    cy += ls.paddingTop;
+                } else if (ls.alignmentY == UiLayoutSettings::Center) {
+                    cy += (height - child->height) / 2.0f;
+                } else if (ls.alignmentY == UiLayoutSettings::End) {
+                    cy += height - child->height - ls.paddingBottom;
+                }
 
-} else if (ls.type == UiLayoutSettings::Horizontal) {
-    px += ls.paddingLeft;
+                if (ls.alignmentX == UiLayoutSettings::Center) {
+                    cx += (width - ls.paddingLeft - ls.paddingRight - totalWidth) / 2.0f;
+                } else if (ls.alignmentX == UiLayoutSettings::End) {
+                    cx += (width - ls.paddingLeft - ls.paddingRight - totalWidth);
+                }
+            }
 
-    for (UiFrame* child : parent->children) {
-        if (child == this) break;
-        px += child->width + ls.spacingX;
-    }
+            // a frame's own position is an offset from where its parent's layout puts it
+            cx += child->x;
+            cy += child->y;
+            if (cx != child->layoutX || cy != child->layoutY) {
+                child->layoutX = cx;
+                child->layoutY = cy;
+                child->layoutDirty = true;
+                uiLayoutVersion++;
+            }
+            index++;
+        }
 
-    if (ls.alignmentY == UiLayoutSettings::Start) {
-        py += ls.paddingTop;
-    } else if (ls.alignmentY == UiLayoutSettings::Center) {
-        py += (parent->height - height) / 2.0f;
-    } else if (ls.alignmentY == UiLayoutSettings::End) {
-        py += parent->height - height - ls.paddingBottom;
+        layoutDirty = false;
     }
+}
 
-    // missing: x alignment of the whole block within parent
-    float totalWidth = 0;
-    for (UiFrame* child : parent->children) {
-        totalWidth += child->width + ls.spacingX;
+void UiFrame::updateLayout()
+{
+    UiFrame* root = this;
+    while (root->parent && root->parent != root) {
+        root = root->parent;
     }
-    totalWidth -= ls.spacingX; // remove trailing spacing
 
-    if (ls.alignmentX == UiLayoutSettings::Center) {
-        px += (parent->width - ls.paddingLeft - ls.paddingRight - totalWidth) / 2.0f;
-    } else if (ls.alignmentX == UiLayoutSettings::End) {
-        px += (parent->width - ls.paddingLeft - ls.paddingRight - totalWidth);
+    if (root == mainFrame) {
+        uiTree.update(root, true);
+    } else {
+        UiTree tree;
+        tree.update(root, false);
     }
 }
 
-    return std::make_tuple(px, py);
-}
-
 void UiFrame::calculateAutoSize()
 {
-    // recurse children first (bottom-up)
-    for (UiFrame* child : children) {
-        child->calculateAutoSize();
-    }
-
-    const auto& ls = layoutSettings;
-
-    if (!ls.autoSizeWidth && !ls.autoSizeHeight) return;
-    if (ls.type == UiLayoutSettings::None) return;
-
-    float contentWidth  = 0;
-    float contentHeight = 0;
-
-    if (ls.type == UiLayoutSettings::Vertical) {
-        for (UiFrame* child : children) {
-            contentWidth   = std::max(contentWidth, child->width);
-            contentHeight += child->height + ls.spacingY;
-        }
-        if (!children.empty()) contentHeight -= ls.spacingY; // remove trailing
-
-    } else if (ls.type == UiLayoutSettings::Horizontal) {
-        for (UiFrame* child : children) {
-            contentWidth  += child->width + ls.spacingX;
-            contentHeight  = std::max(contentHeight, child->height);
-        }
-        if (!children.empty()) contentWidth -= ls.spacingX;
-
-    } else if (ls.type == UiLayoutSettings::Grid) {
-        if (ls.columns <= 0 || ls.rows <= 0) return;
-
-        // find the largest cell
-        float maxCellW = 0, maxCellH = 0;
-        for (UiFrame* child : children) {
-            maxCellW = std::max(maxCellW, child->width);
-            maxCellH = std::max(maxCellH, child->height);
-        }
+    // auto sizes are part of the layout update, which only redoes the containers whose children changed
+    updateLayout();
+}
 
-        contentWidth  = ls.columns * maxCellW + ls.spacingX * (ls.columns - 1);
-        contentHeight = ls.rows    * maxCellH + ls.spacingY * (ls.rows    - 1);
+void UiFrame::setImage(const char* path)
+{
+    GlAtlasRegion region;
+    if (!glAtlasLookup(path, &region)) {
+        ioDebugPrint("Failed to load UI image: %s\n", path);
+        return;
     }
 
-    if (ls.autoSizeWidth)
-        width  = contentWidth  + ls.paddingLeft + ls.paddingRight;
-
-    if (ls.autoSizeHeight) {
-        height = contentHeight + ls.paddingTop  + ls.paddingBottom;
-    }
+    texture = region.texture;
+    u0 = region.u0;
+    v0 = region.v0;
+    u1 = region.u1;
+    v1 = region.v1;
 }
 
 void UiFrame::setParent(UiFrame& parent)
@@ -799,21 +1523,20 @@ void UiFrame::setParent(UiFrame& parent)
 
     parent.children.push_back(this);
     this->parent = &parent;
+    parent.layoutDirty = true;
+    uiTreeVersion++;
 
 
 }
 
 void UiFrame::applyLayout()
 {
-    preLayout = std::make_tuple(x, y);
-
-    std::tuple<float,float> layoutPos = getLayoutPosition();
+    updateLayout();
 
-    x += std::get<0>(layoutPos);
-    y += std::get<1>(layoutPos);
-
-    for (UiFrame* child : children) {
-        child->applyLayout();
+    for (UiFrame* frame : getAllFrames()) {
+        frame->preLayout = std::make_tuple(frame->x, frame->y);
+        frame->x = frame->layoutX;
+        frame->y = frame->layoutY;
     }
 }
 
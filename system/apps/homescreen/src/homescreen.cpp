@@ -43,12 +43,32 @@ UiFrame& HomeScreen::addFrame(float x, float y, float width, float height, UiFra
     return frame;
 }
 
-void HomeScreen::setSimpleQuad(UiFrame& frame, int shader, int texture)
+void HomeScreen::setSimpleQuad(UiFrame& frame, int texture)
 {
-    frame.shader = shader;
+    // plain image frames keep the default ui shader so they go through the sprite batch
+    frame.shader = -1;
     frame.texture = texture;
 }
 
+void HomeScreen::setSimpleQuad(UiFrame& frame, const char* image)
+{
+    // packed ui images resolve to a region of a shared atlas page
+    frame.shader = -1;
+    frame.setImage(image);
+}
+
+void HomeScreen::drawSelectOverlay(UiFrame& frame)
+{
+    // the carousel button may be drawing with uiAppShader, so switch programs before setting uniforms
+    glShaderUse(uiShader);
+    glShaderSetFloat(uiShader, uiShaderAlphaSlot, frame.alpha);
+    glShaderSetVec3(uiShader, uiShaderColorSlot, vec3(1.0f, 1.0f, 1.0f));
+
+    glTextureBind(0, appIcon_select);
+    glShaderSetInt(uiShader, uiShaderTexSlot, 0);
+    glQuadDraw(frame.x, frame.y, frame.width, frame.height, uiShader);
+}
+
 void HomeScreen::loadTitles()
 {
     hsProbe("loadTitles: begin");
@@ -87,46 +107,22 @@ void HomeScreen::loadTextures()
     ioDebugPrint("Loading textures...\n");
 
     hsProbe("loadTextures: appIcon_empty");
-    appIcon_empty = glGenerateTexture("S:/AppEmpty.png", 4);
+    appIcon_empty = glGenerateTextureAsync("S:/AppEmpty.png", 4);
 
     hsProbe("loadTextures: appIcon_filled");
-    appIcon_filled = glGenerateTexture("S:/AppFilled.png", 4);
+    appIcon_filled = glGenerateTextureAsync("S:/AppFilled.png", 4);
 
     hsProbe("loadTextures: appIcon_select");
-    appIcon_select = glGenerateTexture("S:/AppSelectOverlay.png", 4);
-
-    hsProbe("loadTextures: sidebar_frame");
-    sidebar_frame = glGenerateTexture("S:/SidebarFrame.png", 4);
-
-    hsProbe("loadTextures: sidebar_button");
-    sidebar_button = glGenerateTexture("S:/SidebarButton.png", 4);
-
-    hsProbe("loadTextures: sidebar_mii_icon");
-    sidebar_mii_icon = glGenerateTexture("S:/UserIconButton.png", 4);
-
-    hsProbe("loadTextures: achievement_frame");
-    achievement_frame = glGenerateTexture("S:/AchievementFrame.png", 4);
-
-    hsProbe("loadTextures: achievement_container");
-    achievement_container = glGenerateTexture("S:/AchievementContainer.png", 4);
+    appIcon_select = glGenerateTextureAsync("S:/AppSelectOverlay.png", 4);
 
     hsProbe("loadTextures: background_gradient");
-    background_gradient = glGenerateTexture("S:/BackgroundFade.png", 4);
+    background_gradient = glGenerateTextureAsync("S:/BackgroundFade.png", 4);
 
     hsProbe("loadTextures: background_test_image");
-    background_test_image = glGenerateTexture("S:/BackgroundTest.png", 4);
-
-    {
-        GLuint tex;
-        glGenTextures(1, &tex);
-        glBindTexture(GL_TEXTURE_2D, tex);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 800, 480, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        background_screenshot = tex;
+    background_test_image = glGenerateTextureAsync("S:/BackgroundTest.png", 4);
 
-
-    }
+    // filled by onGameReturn
+    background_screenshot = 0;
 
     ioDebugPrint("Textures loaded: app icons, sidebar, achievements, background\n");
     hsProbe("loadTextures: end");
@@ -148,18 +144,11 @@ void HomeScreen::buildShaders()
         uniform vec2 position;
         uniform vec2 scale;
 
-        #define SCREEN_WIDTH 800.0
-        #define SCREEN_HEIGHT 480.0
-        
         void main() {
 
             // generate screen-space position
             vec2 scaledPos = aPos * scale;
-            vec2 screenPos = position + scaledPos;
-            vec2 ndcPos = (screenPos / vec2(SCREEN_WIDTH, SCREEN_HEIGHT)) * 2.0 - 1.0;
-            ndcPos.y = -ndcPos.y; // Flip Y for OpenGL coordinate system
-
-            gl_Position = vec4(ndcPos, 0.0, 1.0);
+            gl_Position = glintCanvasToClip(position + scaledPos);
             TexCoord = aTexCoord;
         }
         )",
@@ -206,18 +195,11 @@ void HomeScreen::buildShaders()
         uniform vec2 position;
         uniform vec2 scale;
 
-        #define SCREEN_WIDTH 800.0
-        #define SCREEN_HEIGHT 480.0
-        
         void main() {
 
             // generate screen-space position
             vec2 scaledPos = aPos * scale;
-            vec2 screenPos = position + scaledPos;
-            vec2 ndcPos = (screenPos / vec2(SCREEN_WIDTH, SCREEN_HEIGHT)) * 2.0 - 1.0;
-            ndcPos.y = -ndcPos.y; // Flip Y for OpenGL coordinate system
-
-            gl_Position = vec4(ndcPos, 0.0, 1.0);
+            gl_Position = glintCanvasToClip(position + scaledPos);
             TexCoord = aTexCoord;
         }
         )",
@@ -243,6 +225,14 @@ void HomeScreen::buildShaders()
         )"
     );
 
+    uiAppTexSlot = glShaderGetUniform(uiAppShader, "tex");
+    uiAppOverlaySlot = glShaderGetUniform(uiAppShader, "overlay");
+    uiAppHasOverlaySlot = glShaderGetUniform(uiAppShader, "hasOverlay");
+
+    uiShaderTexSlot = glShaderGetUniform(uiShader, "tex");
+    uiShaderAlphaSlot = glShaderGetUniform(uiShader, "alphaValue");
+    uiShaderColorSlot = glShaderGetUniform(uiShader, "color");
+
     ioDebugPrint("Shaders built successfully\n");
 
 }
@@ -253,8 +243,9 @@ void HomeScreen::buildUi()
 
     ui2dInit();
 
-    homeFrame = addFrame(0, 0, 800, 480);
-    homeFrame.setAsMainFrame();
+    vec2 canvas = glCanvasGetSize();
+    homeFrame = &addFrame(0, 0, canvas.x, canvas.y);
+    homeFrame->setAsMainFrame();
 
     buildBackground();
     buildSidebar();
@@ -266,7 +257,8 @@ void HomeScreen::buildUi()
 
 void HomeScreen::buildBackground()
 {
-    UiFrame& bgFrame = addFrame(0, 0, 800, 480);
+    vec2 canvas = glCanvasGetSize();
+    UiFrame& bgFrame = addFrame(0, 0, canvas.x, canvas.y);
     //bgFrame.color = {0.25f, 0.25f, 0.25f};
     bgFrame.shader = uiShader;
     bgFrame.texture = background_test_image;
@@ -275,14 +267,14 @@ void HomeScreen::buildBackground()
     bgEffects.blurRadius = 3;
     backgroundFrame = &bgFrame;
 
-    UiFrame& bgImageFrame = addFrame(0, 0, 800, 480, backgroundFrame);
-    setSimpleQuad(bgImageFrame, uiShader, background_gradient);
+    UiFrame& bgImageFrame = addFrame(0, 0, canvas.x, canvas.y, backgroundFrame);
+    setSimpleQuad(bgImageFrame, background_gradient);
 }
 
 void HomeScreen::buildSidebar()
 {
     UiFrame& sidebarFrame = addFrame(0, 24, 68, 232);
-    setSimpleQuad(sidebarFrame, uiShader, sidebar_frame);
+    setSimpleQuad(sidebarFrame, "S:/SidebarFrame.png");
 
     UiFrame& sidebar = addFrame(0, 27, 62, 224, &sidebarFrame);
     sidebar.visible = true;
@@ -297,14 +289,13 @@ void HomeScreen::buildSidebar()
 
     for (int i = 0; i < 5; i++) {
         UiFrame& button = addFrame(0, 0, 35, 35, &sidebar);
-        int texture = (i == 0) ? sidebar_mii_icon : sidebar_button;
-        setSimpleQuad(button, uiShader, texture);
+        setSimpleQuad(button, (i == 0) ? "S:/UserIconButton.png" : "S:/SidebarButton.png");
     }
 }
 
 void HomeScreen::buildCarousel()
 {
-    UiFrame& carousel = addFrame(300, 0, 125, 480);
+    UiFrame& carousel = addFrame(300, 0, 125, glCanvasGetSize().y);
     gameCarousel = &carousel;
 
     auto& layout = carousel.getLayoutSettings();
@@ -338,23 +329,13 @@ void HomeScreen::buildCarousel()
                 frame.height = lerp(frame.height, 100, glGetDeltaTime() * 15);
             }
 
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, appIcon_empty);
-            glUniform1i(glGetUniformLocation(uiShader, "tex"), 0);
-
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, appIcon_empty);
-            glUniform1i(glGetUniformLocation(uiShader, "overlay"), 1);
-            glUniform1i(glGetUniformLocation(uiShader, "hasOverlay"), 0);
+            glTextureBind(0, appIcon_empty);
+            glShaderSetInt(uiShader, uiShaderTexSlot, 0);
 
             glQuadDraw(frame.x, frame.y, frame.width, frame.height, uiShader);
 
             if (frame.isSelected()) {
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, appIcon_select);
-                glUniform1i(glGetUniformLocation(uiShader, "tex"), 0);
-                glUniform1i(glGetUniformLocation(uiShader, "hasOverlay"), 0);
-                glQuadDraw(frame.x, frame.y, frame.width, frame.height, uiShader);
+                drawSelectOverlay(frame);
             }
         };
 
@@ -394,28 +375,21 @@ void HomeScreen::buildCarousel()
 
             bool hasTitle = i < titles.size();
 
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, hasTitle ? appIcon_filled : appIcon_empty);
-            glUniform1i(glGetUniformLocation(uiAppShader, "tex"), 0);
+            glTextureBind(0, hasTitle ? appIcon_filled : appIcon_empty);
+            glShaderSetInt(uiAppShader, uiAppTexSlot, 0);
 
             if (hasTitle) {
-                glActiveTexture(GL_TEXTURE1);
-                glBindTexture(GL_TEXTURE_2D, titles[i].icon_texture);
+                glTextureBind(1, titles[i].icon_texture);
             } else {
-                glActiveTexture(GL_TEXTURE1);
-                glBindTexture(GL_TEXTURE_2D, appIcon_empty);
+                glTextureBind(1, appIcon_empty);
             }
-            glUniform1i(glGetUniformLocation(uiAppShader, "overlay"), 1);
-            glUniform1i(glGetUniformLocation(uiAppShader, "hasOverlay"), hasTitle ? 1 : 0);
+            glShaderSetInt(uiAppShader, uiAppOverlaySlot, 1);
+            glShaderSetInt(uiAppShader, uiAppHasOverlaySlot, hasTitle ? 1 : 0);
 
             glQuadDraw(frame.x, frame.y, frame.width, frame.height, uiAppShader);
 
             if (frame.isSelected()) {
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, appIcon_select);
-                glUniform1i(glGetUniformLocation(uiShader, "tex"), 0);
-                glUniform1i(glGetUniformLocation(uiShader, "hasOverlay"), 0);
-                glQuadDraw(frame.x, frame.y, frame.width, frame.height, uiShader);
+                drawSelectOverlay(frame);
             }
         };
 
@@ -481,23 +455,13 @@ void HomeScreen::buildCarousel()
                 frame.height = lerp(frame.height, 100, glGetDeltaTime() * 15);
             }
 
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, appIcon_empty);
-            glUniform1i(glGetUniformLocation(uiShader, "tex"), 0);
-
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, appIcon_empty);
-            glUniform1i(glGetUniformLocation(uiShader, "overlay"), 1);
-            glUniform1i(glGetUniformLocation(uiShader, "hasOverlay"), 0);
+            glTextureBind(0, appIcon_empty);
+            glShaderSetInt(uiShader, uiShaderTexSlot, 0);
 
             glQuadDraw(frame.x, frame.y, frame.width, frame.height, uiShader);
 
             if (frame.isSelected()) {
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, appIcon_select);
-                glUniform1i(glGetUniformLocation(uiShader, "tex"), 0);
-                glUniform1i(glGetUniformLocation(uiShader, "hasOverlay"), 0);
-                glQuadDraw(frame.x, frame.y, frame.width, frame.height, uiShader);
+                drawSelectOverlay(frame);
             }
         };
 
@@ -512,14 +476,14 @@ void HomeScreen::buildGameInfo()
     infoFrame.visible = true;
 
     //UiFrame& titleText = addFrame(72, 42, 215, 27, &infoFrame);
-    //setSimpleQuad(titleText, uiShader, 0);
+    //setSimpleQuad(titleText, 0);
 
     //UiFrame& timeText = addFrame(72, 73, 215, 14, &infoFrame);
-    //setSimpleQuad(timeText, uiShader, 0);
+    //setSimpleQuad(timeText, 0);
 
     UiFrame& achievContainer = addFrame(80.07f, 400, 201.88f, 181, &infoFrame);
     achievContainer.getLayoutSettings().relativeChildren = true;
-    setSimpleQuad(achievContainer, uiShader, achievement_container);
+    setSimpleQuad(achievContainer, "S:/AchievementContainer.png");
     gameAchievementPanel = &achievContainer;
 
     UiFrame& achievFrameContainer = addFrame(5, 5, 0, 0, &achievContainer);
@@ -540,24 +504,24 @@ void HomeScreen::buildGameInfo()
         achievFrame.visible = true;
 
         UiFrame& achievFrameBG = addFrame(0, 0, 180, 37.5f, &achievFrame);
-        setSimpleQuad(achievFrameBG, uiShader, achievement_frame);
+        setSimpleQuad(achievFrameBG, "S:/AchievementFrame.png");
 
         //UiFrame& achievText = addFrame(8, 5, 104, 11, &achievFrame);
-        //setSimpleQuad(achievText, uiShader, 0);
+        //setSimpleQuad(achievText, 0);
 
         //UiFrame& achievDesc = addFrame(8, 19, 104, 14, &achievFrame);
-        //setSimpleQuad(achievDesc, uiShader, 0);
+        //setSimpleQuad(achievDesc, 0);
 
         //UiFrame& achievProg = addFrame(115, 5, 55, 28, &achievFrame);
-        //setSimpleQuad(achievProg, uiShader, 0);
+        //setSimpleQuad(achievProg, 0);
     }
 }
 
 
 void HomeScreen::onGameExit()
 {
-    GLFWwindow* window = (GLFWwindow*)glGetContext();
-    glfwMakeContextCurrent(window);
+    // take the context back from the title thread; this also resets glint's state cache
+    glAttach(glGetContext());
 
     glDisable(GL_DEPTH_TEST);
 
@@ -569,32 +533,14 @@ void HomeScreen::onGameExit()
 void HomeScreen::onGameReturn()
 {
 
-    GLFWwindow* window = (GLFWwindow*)glGetContext();
-    glfwMakeContextCurrent(window);
+    // take the context back from the title thread; this also resets glint's state cache
+    glAttach(glGetContext());
 
 
     glDisable(GL_DEPTH_TEST);
 
-    int width = 800, height = 480, channels = 4;
-    GLubyte* pixels = new GLubyte[channels * width * height];
-    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
-
-    // Flip vertically
-    int rowSize = width * channels;
-    GLubyte* temp = new GLubyte[rowSize];
-    for (int y = 0; y < height / 2; y++) {
-        GLubyte* top    = pixels + y * rowSize;
-        GLubyte* bottom = pixels + (height - 1 - y) * rowSize;
-        memcpy(temp, top, rowSize);
-        memcpy(top, bottom, rowSize);
-        memcpy(bottom, temp, rowSize);
-    }
-    delete[] temp;
-
-    glBindTexture(GL_TEXTURE_2D, background_screenshot);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
-    delete[] pixels;
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // copy the game's last frame on the GPU; it is shown blurred, so half resolution is plenty
+    background_screenshot = glCaptureFramebufferToTexture(background_screenshot, 0.5f);
 
     // show pause menu
     isPauseMenuVisible = true;
@@ -635,7 +581,7 @@ void HomeScreen::update() {
 
     float targetY = -1 * gameCarouselIndex * (100 + 15); // item size + spacing
 
-    targetY += (480/2) - (125/2); // center the carousel items vertically
+    targetY += (glCanvasGetSize().y / 2) - (125/2); // center the carousel items vertically
 
     gameCarousel->y = lerp(gameCarousel->y, targetY, glGetDeltaTime() * 15);
 
@@ -726,6 +672,15 @@ void HomeScreen::render() {
     glDebugTextFmt("Hello, Glint! Time: %.2f", glGetTime());
     // delta time
     glDebugTextFmt("Delta Time: %.4f", glGetDeltaTime());
+    // gl state cache savings for the previous frame
+    GlStateStats stateStats = glGetStateStats();
+    glDebugTextFmt("GL State: %d issued, %d skipped", stateStats.issued, stateStats.skipped);
+    // program binary cache since startup
+    GlShaderCacheStats shaderStats = glGetShaderCacheStats();
+    glDebugTextFmt("Shaders: %d cached, %d compiled, %.1f ms saved", shaderStats.hits, shaderStats.misses, shaderStats.savedMs);
+
+    GlRenderTargetStats targetStats = glGetRenderTargetStats();
+    glDebugTextFmt("Targets: %d (%d in use), %.1f KB", targetStats.targets, targetStats.inUse, targetStats.bytes / 1024.0);
 
 
     ui2dDraw();
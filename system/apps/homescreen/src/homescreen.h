@@ -33,7 +33,9 @@ private:
     void buildGameInfo();
 
     UiFrame& addFrame(float x, float y, float width, float height, UiFrame* parent = nullptr);
-    void setSimpleQuad(UiFrame& frame, int shader, int texture);
+    void setSimpleQuad(UiFrame& frame, int texture);
+    void setSimpleQuad(UiFrame& frame, const char* image);
+    void drawSelectOverlay(UiFrame& frame);
 
 
     // assets
@@ -41,13 +43,6 @@ private:
     int appIcon_filled;
     int appIcon_select;
     
-    int sidebar_frame;
-    int sidebar_button;
-    int sidebar_mii_icon;
-
-    int achievement_frame;
-    int achievement_container;
-
     int background_gradient;
     int background_test_image;
     int background_screenshot;
@@ -55,8 +50,16 @@ private:
     int uiAppShader;
     int uiShader;
 
+    // uniform slots, resolved in buildShaders
+    int uiAppTexSlot;
+    int uiAppOverlaySlot;
+    int uiAppHasOverlaySlot;
+    int uiShaderTexSlot;
+    int uiShaderAlphaSlot;
+    int uiShaderColorSlot;
+
     // ui
-    UiFrame homeFrame;
+    UiFrame* homeFrame;
     UiFrame* gameCarousel;
     UiFrame* gameAchievementPanel;
     UiFrame* backgroundFrame;
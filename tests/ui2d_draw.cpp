@@ -0,0 +1,206 @@
+// draws a nested scene through ui2dDraw and compares the frame with the same sprites drawn one by one at
+// positions worked out by hand from the layout rules, across moves, visibility changes, a destroy and an add
+#include "glint/glint.h"
+#include <glad/glad.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#define SCREEN_WIDTH 800
+#define SCREEN_HEIGHT 480
+
+struct ReferenceSprite {
+    float x, y, width, height;
+    float alpha;
+    ColorRGB color;
+};
+
+static void clearFrame()
+{
+    glClearColor(0.1f, 0.1f, 0.2f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+static std::vector<unsigned char> drawScene()
+{
+    std::vector<unsigned char> pixels(SCREEN_WIDTH * SCREEN_HEIGHT * 4);
+    clearFrame();
+    ui2dUpdate();
+    ui2dDraw();
+    glReadFrame(pixels.data());
+    glPresent();
+    return pixels;
+}
+
+static std::vector<unsigned char> drawReference(const std::vector<ReferenceSprite>& sprites, int texture)
+{
+    std::vector<unsigned char> pixels(SCREEN_WIDTH * SCREEN_HEIGHT * 4);
+    clearFrame();
+    for (const ReferenceSprite& reference : sprites) {
+        GlSprite sprite;
+        sprite.x = reference.x;
+        sprite.y = reference.y;
+        sprite.width = reference.width;
+        sprite.height = reference.height;
+        sprite.alpha = reference.alpha;
+        sprite.tint = reference.color;
+        sprite.texture = texture;
+        glSpriteBatchDraw(sprite);
+    }
+    glSpriteBatchFlush();
+    glReadFrame(pixels.data());
+    glPresent();
+    return pixels;
+}
+
+static bool compare(const char* step, const std::vector<ReferenceSprite>& sprites, int texture)
+{
+    std::vector<unsigned char> actual = drawScene();
+    std::vector<unsigned char> expected = drawReference(sprites, texture);
+
+    // the first pixel is background in every step, so anything else shows the reference drew something
+    int covered = 0;
+    int mismatches = 0;
+    for (size_t i = 0; i < expected.size(); i += 4) {
+        bool background = true;
+        bool differs = false;
+        for (int c = 0; c < 3; ++c) {
+            background = background && expected[i + c] == expected[c];
+            differs = differs || std::abs(actual[i + c] - expected[i + c]) > 1;
+        }
+        covered += background ? 0 : 1;
+        if (differs) {
+            if (mismatches < 5) {
+                int pixel = static_cast<int>(i / 4);
+                printf("%s: pixel %d,%d is %d,%d,%d, expected %d,%d,%d\n", step, pixel % SCREEN_WIDTH, pixel / SCREEN_WIDTH,
+                       actual[i], actual[i + 1], actual[i + 2], expected[i], expected[i + 1], expected[i + 2]);
+            }
+            mismatches++;
+        }
+    }
+
+    printf("%s: %d pixels covered, %d differ\n", step, covered, mismatches);
+    return covered > 0 && mismatches == 0;
+}
+
+int main()
+{
+    if (!glSetup(true)) {
+        printf("no headless context\n");
+        return 1;
+    }
+    ui2dInit();
+
+    // a gradient with soft edges, so the blending and orientation of every quad show up in the comparison
+    std::vector<unsigned char> image(16 * 16 * 4);
+    for (int y = 0; y < 16; ++y) {
+        for (int x = 0; x < 16; ++x) {
+            unsigned char* texel = &image[(y * 16 + x) * 4];
+            texel[0] = static_cast<unsigned char>(x * 16);
+            texel[1] = static_cast<unsigned char>(y * 16);
+            texel[2] = 200;
+            texel[3] = (x == 0 || y == 0 || x == 15 || y == 15) ? 96 : 255;
+        }
+    }
+    int texture = glGenerateTexture(16, 16, image.data(), 4);
+
+    auto addFrame = [texture](float x, float y, float width, float height, float alpha, ColorRGB color) -> UiFrame& {
+        UiFrame& frame = ui2dAddFrame(x, y, width, height);
+        frame.texture = texture;
+        frame.alpha = alpha;
+        frame.color = color;
+        return frame;
+    };
+
+    // a vertical list with a nested child, a hidden panel and a horizontal row
+    UiFrame& list = addFrame(40, 30, 360, 260, 0.9f, ColorRGB(0.4f, 0.4f, 0.8f));
+    UiLayoutSettings& listLayout = list.getLayoutSettings();
+    listLayout.type = UiLayoutSettings::Vertical;
+    listLayout.paddingLeft = 10;
+    listLayout.paddingTop = 10;
+    listLayout.spacingY = 8;
+
+    UiFrame& first = addFrame(0, 0, 120, 60, 0.8f, ColorRGB(1.0f, 0.5f, 0.5f));
+    first.setParent(list);
+    UiFrame& second = addFrame(20, 0, 100, 50, 0.6f, ColorRGB(0.5f, 1.0f, 0.5f));
+    second.setParent(list);
+    second.getLayoutSettings().relativeChildren = true;
+    UiFrame& badge = addFrame(10, 10, 30, 30, 0.5f, ColorRGB(1.0f, 1.0f, 0.2f));
+    badge.setParent(second);
+    UiFrame& third = addFrame(0, 0, 80, 40, 1.0f, ColorRGB(0.2f, 0.8f, 1.0f));
+    third.forceAlpha = true;
+    third.setParent(list);
+
+    UiFrame& panel = addFrame(450, 40, 200, 200, 1.0f, ColorRGB(0.7f, 0.7f, 0.7f));
+    panel.visible = false;
+    panel.getLayoutSettings().relativeChildren = true;
+    UiFrame& panelChild = addFrame(20, 20, 50, 50, 1.0f, ColorRGB(1.0f, 0.2f, 1.0f));
+    panelChild.setParent(panel);
+
+    UiFrame& row = addFrame(430, 260, 300, 180, 0.5f, ColorRGB(0.9f, 0.6f, 0.3f));
+    UiLayoutSettings& rowLayout = row.getLayoutSettings();
+    rowLayout.type = UiLayoutSettings::Horizontal;
+    rowLayout.paddingLeft = 6;
+    rowLayout.paddingTop = 6;
+    rowLayout.spacingX = 12;
+    UiFrame& cell0 = addFrame(0, 0, 60, 60, 1.0f, ColorRGB(1.0f, 1.0f, 1.0f));
+    cell0.setParent(row);
+    UiFrame& cell1 = addFrame(0, 0, 80, 40, 1.0f, ColorRGB(0.3f, 0.3f, 1.0f));
+    cell1.setParent(row);
+    UiFrame& cell2 = addFrame(0, 0, 40, 100, 1.0f, ColorRGB(1.0f, 0.3f, 0.3f));
+    cell2.setParent(row);
+
+    bool ok = compare("initial", {
+        {40, 30, 360, 260, 0.9f, ColorRGB(0.4f, 0.4f, 0.8f)},
+        {50, 40, 120, 60, 0.72f, ColorRGB(1.0f, 0.5f, 0.5f)},
+        {70, 108, 100, 50, 0.54f, ColorRGB(0.5f, 1.0f, 0.5f)},
+        {80, 118, 30, 30, 0.27f, ColorRGB(1.0f, 1.0f, 0.2f)},
+        {50, 166, 80, 40, 1.0f, ColorRGB(0.2f, 0.8f, 1.0f)},
+        {430, 260, 300, 180, 0.5f, ColorRGB(0.9f, 0.6f, 0.3f)},
+        {436, 266, 60, 60, 0.5f, ColorRGB(1.0f, 1.0f, 1.0f)},
+        {508, 266, 80, 40, 0.5f, ColorRGB(0.3f, 0.3f, 1.0f)},
+        {600, 266, 40, 100, 0.5f, ColorRGB(1.0f, 0.3f, 0.3f)},
+    }, texture);
+
+    // moving a container carries its subtree; a wider cell pushes the next one along
+    list.x = 60;
+    third.visible = false;
+    panel.visible = true;
+    cell1.width = 100;
+    row.alpha = 1.0f;
+
+    ok = compare("changed", {
+        {60, 30, 360, 260, 0.9f, ColorRGB(0.4f, 0.4f, 0.8f)},
+        {70, 40, 120, 60, 0.72f, ColorRGB(1.0f, 0.5f, 0.5f)},
+        {90, 108, 100, 50, 0.54f, ColorRGB(0.5f, 1.0f, 0.5f)},
+        {100, 118, 30, 30, 0.27f, ColorRGB(1.0f, 1.0f, 0.2f)},
+        {450, 40, 200, 200, 1.0f, ColorRGB(0.7f, 0.7f, 0.7f)},
+        {470, 60, 50, 50, 1.0f, ColorRGB(1.0f, 0.2f, 1.0f)},
+        {430, 260, 300, 180, 1.0f, ColorRGB(0.9f, 0.6f, 0.3f)},
+        {436, 266, 60, 60, 1.0f, ColorRGB(1.0f, 1.0f, 1.0f)},
+        {508, 266, 100, 40, 1.0f, ColorRGB(0.3f, 0.3f, 1.0f)},
+        {620, 266, 40, 100, 1.0f, ColorRGB(1.0f, 0.3f, 0.3f)},
+    }, texture) && ok;
+
+    // destroying a frame closes its gap in the list, and a new frame joins the end of the row
+    ui2dDestroyFrame(second);
+    third.visible = true;
+    UiFrame& cell3 = addFrame(0, 0, 30, 30, 1.0f, ColorRGB(0.3f, 1.0f, 0.3f));
+    cell3.setParent(row);
+
+    ok = compare("rebuilt", {
+        {60, 30, 360, 260, 0.9f, ColorRGB(0.4f, 0.4f, 0.8f)},
+        {70, 40, 120, 60, 0.72f, ColorRGB(1.0f, 0.5f, 0.5f)},
+        {70, 108, 80, 40, 1.0f, ColorRGB(0.2f, 0.8f, 1.0f)},
+        {450, 40, 200, 200, 1.0f, ColorRGB(0.7f, 0.7f, 0.7f)},
+        {470, 60, 50, 50, 1.0f, ColorRGB(1.0f, 0.2f, 1.0f)},
+        {430, 260, 300, 180, 1.0f, ColorRGB(0.9f, 0.6f, 0.3f)},
+        {436, 266, 60, 60, 1.0f, ColorRGB(1.0f, 1.0f, 1.0f)},
+        {508, 266, 100, 40, 1.0f, ColorRGB(0.3f, 0.3f, 1.0f)},
+        {620, 266, 40, 100, 1.0f, ColorRGB(1.0f, 0.3f, 0.3f)},
+        {672, 266, 30, 30, 1.0f, ColorRGB(0.3f, 1.0f, 0.3f)},
+    }, texture) && ok;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+// checks the spatial navigation index against a scan over every selectable frame, on randomly placed and
+// grid-arranged frames, including some placed far outside the screen
+#include "glint/glint.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+void navigateUI(int direction); // what the arrow keys call in ui2dUpdate
+
+static void collectFrames(UiFrame* frame, std::vector<UiFrame*>& frames)
+{
+    frames.push_back(frame);
+    for (UiFrame* child : frame->children) {
+        collectFrames(child, frames);
+    }
+}
+
+// the navigation rules written out as a plain scan; the earliest frame wins a tie
+static UiFrame* scanNeighbour(const std::vector<UiFrame*>& frames, UiFrame* from, int direction)
+{
+    UiRect selected = from->getResolvedRect();
+    UiFrame* best = nullptr;
+    float bestScore = std::numeric_limits<float>::max();
+
+    for (UiFrame* frame : frames) {
+        if (frame == from || !frame->isSelectable()) continue;
+
+        UiRect rect = frame->getResolvedRect();
+        bool inDirection = false;
+        if (direction == 0) {
+            inDirection = rect.y + rect.height <= selected.y;
+        } else if (direction == 1) {
+            inDirection = rect.y >= selected.y + selected.height;
+        } else if (direction == 2) {
+            inDirection = rect.x + rect.width <= selected.x;
+        } else {
+            inDirection = rect.x >= selected.x + selected.width;
+        }
+        if (!inDirection) continue;
+
+        float primaryDist, secondaryDist;
+        if (direction < 2) {
+            primaryDist = std::abs(rect.y - selected.y);
+            secondaryDist = std::abs((rect.x + rect.width / 2) - (selected.x + selected.width / 2));
+        } else {
+            primaryDist = std::abs(rect.x - selected.x);
+            secondaryDist = std::abs((rect.y + rect.height / 2) - (selected.y + selected.height / 2));
+        }
+
+        float score = primaryDist + secondaryDist * 2.0f;
+        if (score < bestScore) {
+            bestScore = score;
+            best = frame;
+        }
+    }
+
+    return best;
+}
+
+int main()
+{
+    if (!glSetup(true)) {
+        printf("no headless context\n");
+        return 1;
+    }
+    ui2dInit();
+    srand(7);
+
+    int checks = 0;
+    int errors = 0;
+
+    for (int round = 0; round < 6; ++round) {
+        int count = (round < 3) ? 60 : 600;
+        bool grid = (round % 2) == 1;
+
+        UiFrame& list = ui2dAddFrame(0, 0, 800, 480);
+        if (grid) {
+            UiLayoutSettings& layout = list.getLayoutSettings();
+            layout.type = UiLayoutSettings::Grid;
+            layout.columns = 25;
+            layout.rows = 24;
+            layout.spacingX = 4;
+            layout.spacingY = 4;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            float x = (rand() % 40) * 20.0f;
+            float y = (rand() % 30) * 16.0f;
+            if (round == 4 && i % 50 == 0) {
+                x += 5000.0f; // off screen, outside the index's usual extent
+            }
+
+            UiFrame& frame = ui2dAddFrame(grid ? 0 : x, grid ? 0 : y, 10 + rand() % 40, 10 + rand() % 30);
+            frame.setParent(list);
+            if (rand() % 5) {
+                frame.onRender = [](UiFrame&) {};
+                frame.onClick = [](UiFrame&) {};
+            }
+        }
+
+        // re-registers every frame in tree order, which is the order ties are broken in
+        ui2dGetMainFrame().setAsMainFrame();
+        ui2dUpdate();
+
+        std::vector<UiFrame*> frames;
+        collectFrames(&ui2dGetMainFrame(), frames);
+
+        for (UiFrame* from : frames) {
+            if (!from->isSelectable()) continue;
+
+            for (int direction = 0; direction < 4; ++direction) {
+                from->select();
+                navigateUI(direction);
+
+                UiFrame* expected = scanNeighbour(frames, from, direction);
+                if (!expected) {
+                    expected = from; // nothing that way, the selection stays
+                }
+
+                checks++;
+                if (!expected->isSelected()) {
+                    if (errors < 10) {
+                        UiRect rect = from->getResolvedRect();
+                        printf("round %d: direction %d from %.0f,%.0f picked another frame\n", round, direction, rect.x, rect.y);
+                    }
+                    errors++;
+                }
+            }
+        }
+
+        ui2dDestroyFrame(list);
+    }
+
+    printf("%d checks, %d errors\n", checks, errors);
+    return errors == 0 ? 0 : 1;
+}
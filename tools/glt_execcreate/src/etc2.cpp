@@ -0,0 +1,556 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "etc2.h"
+#include "includes.h"
+
+// the encoder emits individual, differential and planar blocks. differential colors are kept
+// in range, so no block is read back as one of the T/H modes the encoder does not search.
+
+static const int etc_modifiers[8][2] = {
+    {2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}
+};
+
+static const int eac_modifiers[16][8] = {
+    {-3, -6, -9, -15, 2, 5, 8, 14},
+    {-3, -7, -10, -13, 2, 6, 9, 12},
+    {-2, -5, -8, -13, 1, 4, 7, 12},
+    {-2, -4, -6, -13, 1, 3, 5, 12},
+    {-3, -6, -8, -12, 2, 5, 7, 11},
+    {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10},
+    {-3, -5, -8, -11, 2, 4, 7, 10},
+    {-2, -6, -8, -10, 1, 5, 7, 9},
+    {-2, -5, -8, -10, 1, 4, 7, 9},
+    {-2, -4, -8, -10, 1, 3, 7, 9},
+    {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},
+    {-1, -2, -3, -10, 0, 1, 2, 9},
+    {-4, -6, -8, -9, 3, 5, 7, 8},
+    {-3, -5, -7, -9, 2, 4, 6, 8}
+};
+
+// a 4x4 block, pixels in ETC order (column major: index = x * 4 + y)
+struct etc_block {
+    int r[16], g[16], b[16], a[16];
+};
+
+static int clamp255(int value)
+{
+    return std::min(std::max(value, 0), 255);
+}
+
+static int modifier_value(int table, int index)
+{
+    // index bits (msb, lsb): 00 +small, 01 +large, 10 -small, 11 -large
+    int value = etc_modifiers[table][index & 1];
+    return (index & 2) ? -value : value;
+}
+
+static int expand4(int c) { return (c << 4) | c; }
+static int expand5(int c) { return (c << 3) | (c >> 2); }
+static int expand6(int c) { return (c << 2) | (c >> 4); }
+static int expand7(int c) { return (c << 1) | (c >> 6); }
+
+static int square(int v) { return v * v; }
+
+static void load_block(const unsigned char* rgba, int width, int height, int bx, int by, etc_block& block)
+{
+    for (int x = 0; x < 4; x++) {
+        for (int y = 0; y < 4; y++) {
+            // partial blocks at the right and bottom edge repeat the last pixel
+            int sx = std::min(bx + x, width - 1);
+            int sy = std::min(by + y, height - 1);
+            const unsigned char* p = rgba + (static_cast<size_t>(sy) * width + sx) * 4;
+            int i = x * 4 + y;
+            block.r[i] = p[0];
+            block.g[i] = p[1];
+            block.b[i] = p[2];
+            block.a[i] = p[3];
+        }
+    }
+}
+
+static bool in_subblock(int i, bool flip, int sub)
+{
+    int x = i / 4, y = i % 4;
+    return flip ? ((y >= 2) == (sub == 1)) : ((x >= 2) == (sub == 1));
+}
+
+// picks the best table and per-pixel modifiers for one half of the block around a base color
+static int fit_subblock(const etc_block& block, bool flip, int sub, int br, int bg, int bb, int* table, uint32_t* indices)
+{
+    int best_error = std::numeric_limits<int>::max();
+    for (int t = 0; t < 8; t++) {
+        int error = 0;
+        uint32_t bits = 0;
+        for (int i = 0; i < 16; i++) {
+            if (!in_subblock(i, flip, sub)) continue;
+
+            int best_pixel = std::numeric_limits<int>::max();
+            int best_index = 0;
+            for (int m = 0; m < 4; m++) {
+                int mod = modifier_value(t, m);
+                int e = square(clamp255(br + mod) - block.r[i]) +
+                        square(clamp255(bg + mod) - block.g[i]) +
+                        square(clamp255(bb + mod) - block.b[i]);
+                if (e < best_pixel) {
+                    best_pixel = e;
+                    best_index = m;
+                }
+            }
+            error += best_pixel;
+            bits |= static_cast<uint32_t>(best_index >> 1) << (16 + i);
+            bits |= static_cast<uint32_t>(best_index & 1) << i;
+        }
+        if (error < best_error) {
+            best_error = error;
+            *table = t;
+            *indices = bits;
+        }
+        if (error == 0) break;
+    }
+    return best_error;
+}
+
+static void subblock_average(const etc_block& block, bool flip, int sub, float* r, float* g, float* b)
+{
+    float sr = 0, sg = 0, sb = 0;
+    for (int i = 0; i < 16; i++) {
+        if (!in_subblock(i, flip, sub)) continue;
+        sr += block.r[i];
+        sg += block.g[i];
+        sb += block.b[i];
+    }
+    *r = sr / 8.0f;
+    *g = sg / 8.0f;
+    *b = sb / 8.0f;
+}
+
+static int quantize(float value, int max)
+{
+    return std::min(std::max(static_cast<int>(std::lround(value * max / 255.0f)), 0), max);
+}
+
+// individual or differential mode, whichever fits better, for both flip orientations
+static uint64_t encode_etc1_mode(const etc_block& block, int* out_error)
+{
+    uint64_t best_bits = 0;
+    int best_error = std::numeric_limits<int>::max();
+
+    for (int f = 0; f < 2; f++) {
+        bool flip = f == 1;
+        float avg[2][3];
+        subblock_average(block, flip, 0, &avg[0][0], &avg[0][1], &avg[0][2]);
+        subblock_average(block, flip, 1, &avg[1][0], &avg[1][1], &avg[1][2]);
+
+        // differential: 555 base plus a 333 signed delta, the delta clamped so the block stays in this mode
+        {
+            int c1[3], c2[3];
+            for (int c = 0; c < 3; c++) {
+                c1[c] = quantize(avg[0][c], 31);
+                c2[c] = quantize(avg[1][c], 31);
+                c2[c] = std::min(std::max(c2[c], c1[c] - 4), c1[c] + 3);
+                c2[c] = std::min(std::max(c2[c], 0), 31);
+            }
+
+            int table1, table2;
+            uint32_t idx1, idx2;
+            int error = fit_subblock(block, flip, 0, expand5(c1[0]), expand5(c1[1]), expand5(c1[2]), &table1, &idx1) +
+                        fit_subblock(block, flip, 1, expand5(c2[0]), expand5(c2[1]), expand5(c2[2]), &table2, &idx2);
+            if (error < best_error) {
+                best_error = error;
+                best_bits = 0;
+                for (int c = 0; c < 3; c++) {
+                    uint64_t delta = static_cast<uint64_t>(c2[c] - c1[c]) & 7;
+                    best_bits |= static_cast<uint64_t>(c1[c]) << (59 - c * 8);
+                    best_bits |= delta << (56 - c * 8);
+                }
+                best_bits |= static_cast<uint64_t>(table1) << 37;
+                best_bits |= static_cast<uint64_t>(table2) << 34;
+                best_bits |= 1ull << 33;
+                best_bits |= static_cast<uint64_t>(flip) << 32;
+                best_bits |= idx1 | idx2;
+            }
+        }
+
+        // individual: two independent 444 colors
+        {
+            int c1[3], c2[3];
+            for (int c = 0; c < 3; c++) {
+                c1[c] = quantize(avg[0][c], 15);
+                c2[c] = quantize(avg[1][c], 15);
+            }
+
+            int table1, table2;
+            uint32_t idx1, idx2;
+            int error = fit_subblock(block, flip, 0, expand4(c1[0]), expand4(c1[1]), expand4(c1[2]), &table1, &idx1) +
+                        fit_subblock(block, flip, 1, expand4(c2[0]), expand4(c2[1]), expand4(c2[2]), &table2, &idx2);
+            if (error < best_error) {
+                best_error = error;
+                best_bits = 0;
+                for (int c = 0; c < 3; c++) {
+                    best_bits |= static_cast<uint64_t>(c1[c]) << (60 - c * 8);
+                    best_bits |= static_cast<uint64_t>(c2[c]) << (56 - c * 8);
+                }
+                best_bits |= static_cast<uint64_t>(table1) << 37;
+                best_bits |= static_cast<uint64_t>(table2) << 34;
+                best_bits |= static_cast<uint64_t>(flip) << 32;
+                best_bits |= idx1 | idx2;
+            }
+        }
+    }
+
+    *out_error = best_error;
+    return best_bits;
+}
+
+static int planar_value(int o, int h, int v, int x, int y)
+{
+    return clamp255((x * (h - o) + y * (v - o) + 4 * o + 2) >> 2);
+}
+
+// planar mode: a least-squares plane through the block, good for gradients
+static uint64_t encode_planar_mode(const etc_block& block, int* out_error)
+{
+    const int* channels[3] = {block.r, block.g, block.b};
+    const int maxima[3] = {63, 127, 63};
+    int o[3], h[3], v[3];
+
+    for (int c = 0; c < 3; c++) {
+        float mean = 0, sx = 0, sy = 0;
+        for (int i = 0; i < 16; i++) {
+            float value = static_cast<float>(channels[c][i]);
+            mean += value;
+            sx += (i / 4 - 1.5f) * value;
+            sy += (i % 4 - 1.5f) * value;
+        }
+        mean /= 16.0f;
+        float dx = sx / 20.0f;  // sum of (x - 1.5)^2 over the block
+        float dy = sy / 20.0f;
+        float origin = mean - 1.5f * (dx + dy);
+
+        o[c] = quantize(origin, maxima[c]);
+        h[c] = quantize(origin + 4.0f * dx, maxima[c]);
+        v[c] = quantize(origin + 4.0f * dy, maxima[c]);
+    }
+
+    int eo[3] = {expand6(o[0]), expand7(o[1]), expand6(o[2])};
+    int eh[3] = {expand6(h[0]), expand7(h[1]), expand6(h[2])};
+    int ev[3] = {expand6(v[0]), expand7(v[1]), expand6(v[2])};
+
+    int error = 0;
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 3; c++) {
+            error += square(planar_value(eo[c], eh[c], ev[c], i / 4, i % 4) - channels[c][i]);
+        }
+    }
+    *out_error = error;
+
+    uint64_t bits = 0;
+    bits |= static_cast<uint64_t>(o[0]) << 57;
+    bits |= static_cast<uint64_t>(o[1] >> 6) << 56;
+    bits |= static_cast<uint64_t>(o[1] & 0x3f) << 49;
+    bits |= static_cast<uint64_t>(o[2] >> 5) << 48;
+    bits |= static_cast<uint64_t>((o[2] >> 3) & 3) << 43;
+    bits |= static_cast<uint64_t>((o[2] >> 1) & 3) << 40;
+    bits |= static_cast<uint64_t>(o[2] & 1) << 39;
+    bits |= static_cast<uint64_t>(h[0] >> 1) << 34;
+    bits |= static_cast<uint64_t>(h[0] & 1) << 32;
+    bits |= static_cast<uint64_t>(h[1]) << 25;
+    bits |= static_cast<uint64_t>(h[2] >> 5) << 24;
+    bits |= static_cast<uint64_t>(h[2] & 0x1f) << 19;
+    bits |= static_cast<uint64_t>(v[0]) << 13;
+    bits |= static_cast<uint64_t>(v[1]) << 6;
+    bits |= static_cast<uint64_t>(v[2]);
+    bits |= 1ull << 33;
+
+    // the free bits select planar mode: red and green must stay in range as differential colors, blue must overflow
+    int dr = (static_cast<int>((bits >> 56) & 7) ^ 4) - 4;
+    if (dr < 0) bits |= 1ull << 63;
+    int dg = (static_cast<int>((bits >> 48) & 7) ^ 4) - 4;
+    if (dg < 0) bits |= 1ull << 55;
+    int low_blue = static_cast<int>((bits >> 43) & 3) + static_cast<int>((bits >> 40) & 3);
+    if (low_blue < 4) {
+        bits |= 1ull << 42;                             // base 0..3, delta -4..-1
+    } else {
+        bits |= (1ull << 47) | (1ull << 46) | (1ull << 45);  // base 28..31, delta 0..3
+    }
+
+    return bits;
+}
+
+static uint64_t encode_color_block(const etc_block& block)
+{
+    int etc1_error, planar_error;
+    uint64_t etc1 = encode_etc1_mode(block, &etc1_error);
+    if (etc1_error == 0) {
+        return etc1;
+    }
+    uint64_t planar = encode_planar_mode(block, &planar_error);
+    return planar_error < etc1_error ? planar : etc1;
+}
+
+static int eac_fit(const etc_block& block, int base, int multiplier, int table, uint64_t* indices)
+{
+    int error = 0;
+    uint64_t bits = 0;
+    for (int i = 0; i < 16; i++) {
+        int best_pixel = std::numeric_limits<int>::max();
+        int best_index = 0;
+        for (int m = 0; m < 8; m++) {
+            int e = square(clamp255(base + eac_modifiers[table][m] * multiplier) - block.a[i]);
+            if (e < best_pixel) {
+                best_pixel = e;
+                best_index = m;
+            }
+        }
+        error += best_pixel;
+        bits |= static_cast<uint64_t>(best_index) << (45 - i * 3);
+    }
+    *indices = bits;
+    return error;
+}
+
+static uint64_t encode_alpha_block(const etc_block& block)
+{
+    int lo = 255, hi = 0;
+    for (int i = 0; i < 16; i++) {
+        lo = std::min(lo, block.a[i]);
+        hi = std::max(hi, block.a[i]);
+    }
+
+    // flat alpha is exact with table 13, which has a zero modifier
+    if (lo == hi) {
+        uint64_t bits = static_cast<uint64_t>(lo) << 56;
+        bits |= 1ull << 52;
+        bits |= 13ull << 48;
+        for (int i = 0; i < 16; i++) {
+            bits |= 4ull << (45 - i * 3);
+        }
+        return bits;
+    }
+
+    uint64_t best_bits = 0;
+    int best_error = std::numeric_limits<int>::max();
+    for (int t = 0; t < 16 && best_error > 0; t++) {
+        // modifier 3 is the most negative of a table, modifier 7 the most positive
+        int span = eac_modifiers[t][7] - eac_modifiers[t][3];
+        int center = eac_modifiers[t][7] + eac_modifiers[t][3];
+        int ideal = (hi - lo + span - 1) / span;
+
+        // the multiplier that just covers the range, and its neighbours
+        for (int multiplier = std::max(1, ideal - 1); multiplier <= std::min(15, ideal + 1); multiplier++) {
+            int base = clamp255(static_cast<int>(std::lround((lo + hi) * 0.5 - center * multiplier * 0.5)));
+            for (int offset = -1; offset <= 1; offset++) {
+                uint64_t indices;
+                int b = clamp255(base + offset);
+                int error = eac_fit(block, b, multiplier, t, &indices);
+                if (error < best_error) {
+                    best_error = error;
+                    best_bits = (static_cast<uint64_t>(b) << 56) | (static_cast<uint64_t>(multiplier) << 52) |
+                                (static_cast<uint64_t>(t) << 48) | indices;
+                }
+            }
+        }
+    }
+    return best_bits;
+}
+
+static void put64(unsigned char* out, uint64_t bits)
+{
+    // blocks are stored most significant byte first
+    for (int i = 0; i < 8; i++) {
+        out[i] = static_cast<unsigned char>(bits >> (56 - i * 8));
+    }
+}
+
+static uint64_t get64(const unsigned char* in)
+{
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; i++) {
+        bits = (bits << 8) | in[i];
+    }
+    return bits;
+}
+
+std::vector<unsigned char> etc2_encode(const unsigned char* rgba, int width, int height, bool alpha)
+{
+    int blocks_x = (width + 3) / 4;
+    int blocks_y = (height + 3) / 4;
+    size_t block_size = alpha ? 16 : 8;
+
+    std::vector<unsigned char> out(static_cast<size_t>(blocks_x) * blocks_y * block_size);
+    unsigned char* ptr = out.data();
+
+    etc_block block;
+    for (int by = 0; by < blocks_y; by++) {
+        for (int bx = 0; bx < blocks_x; bx++) {
+            load_block(rgba, width, height, bx * 4, by * 4, block);
+            if (alpha) {
+                put64(ptr, encode_alpha_block(block));
+                ptr += 8;
+            }
+            put64(ptr, encode_color_block(block));
+            ptr += 8;
+        }
+    }
+
+    return out;
+}
+
+static void decode_color_block(uint64_t bits, int* r, int* g, int* b)
+{
+    bool diff = (bits >> 33) & 1;
+
+    if (diff) {
+        bool overflow[3];
+        for (int c = 0; c < 3; c++) {
+            int base = static_cast<int>((bits >> (59 - c * 8)) & 0x1f);
+            int delta = (static_cast<int>((bits >> (56 - c * 8)) & 7) ^ 4) - 4;
+            overflow[c] = base + delta < 0 || base + delta > 31;
+        }
+
+        if (overflow[0] || overflow[1]) {
+            // T and H modes, never written by etc2_encode
+            std::fill(r, r + 16, 0);
+            std::fill(g, g + 16, 0);
+            std::fill(b, b + 16, 0);
+            return;
+        }
+
+        if (overflow[2]) {
+            int o[3], h[3], v[3];
+            o[0] = expand6(static_cast<int>((bits >> 57) & 0x3f));
+            o[1] = expand7(static_cast<int>(((bits >> 56) & 1) << 6 | ((bits >> 49) & 0x3f)));
+            o[2] = expand6(static_cast<int>(((bits >> 48) & 1) << 5 | ((bits >> 43) & 3) << 3 | ((bits >> 40) & 3) << 1 | ((bits >> 39) & 1)));
+            h[0] = expand6(static_cast<int>(((bits >> 34) & 0x1f) << 1 | ((bits >> 32) & 1)));
+            h[1] = expand7(static_cast<int>((bits >> 25) & 0x7f));
+            h[2] = expand6(static_cast<int>((bits >> 19) & 0x3f));
+            v[0] = expand6(static_cast<int>((bits >> 13) & 0x3f));
+            v[1] = expand7(static_cast<int>((bits >> 6) & 0x7f));
+            v[2] = expand6(static_cast<int>(bits & 0x3f));
+
+            for (int i = 0; i < 16; i++) {
+                r[i] = planar_value(o[0], h[0], v[0], i / 4, i % 4);
+                g[i] = planar_value(o[1], h[1], v[1], i / 4, i % 4);
+                b[i] = planar_value(o[2], h[2], v[2], i / 4, i % 4);
+            }
+            return;
+        }
+    }
+
+    bool flip = (bits >> 32) & 1;
+    int colors[2][3];
+    for (int c = 0; c < 3; c++) {
+        if (diff) {
+            int base = static_cast<int>((bits >> (59 - c * 8)) & 0x1f);
+            int delta = (static_cast<int>((bits >> (56 - c * 8)) & 7) ^ 4) - 4;
+            colors[0][c] = expand5(base);
+            colors[1][c] = expand5(base + delta);
+        } else {
+            colors[0][c] = expand4(static_cast<int>((bits >> (60 - c * 8)) & 0xf));
+            colors[1][c] = expand4(static_cast<int>((bits >> (56 - c * 8)) & 0xf));
+        }
+    }
+    int tables[2] = {static_cast<int>((bits >> 37) & 7), static_cast<int>((bits >> 34) & 7)};
+
+    for (int i = 0; i < 16; i++) {
+        int sub = in_subblock(i, flip, 1) ? 1 : 0;
+        int index = static_cast<int>(((bits >> (16 + i)) & 1) << 1 | ((bits >> i) & 1));
+        int mod = modifier_value(tables[sub], index);
+        r[i] = clamp255(colors[sub][0] + mod);
+        g[i] = clamp255(colors[sub][1] + mod);
+        b[i] = clamp255(colors[sub][2] + mod);
+    }
+}
+
+static void decode_alpha_block(uint64_t bits, int* a)
+{
+    int base = static_cast<int>(bits >> 56);
+    int multiplier = static_cast<int>((bits >> 52) & 0xf);
+    int table = static_cast<int>((bits >> 48) & 0xf);
+    for (int i = 0; i < 16; i++) {
+        int index = static_cast<int>((bits >> (45 - i * 3)) & 7);
+        a[i] = clamp255(base + eac_modifiers[table][index] * multiplier);
+    }
+}
+
+void etc2_decode(const unsigned char* blocks, int width, int height, bool alpha, unsigned char* rgba)
+{
+    int blocks_x = (width + 3) / 4;
+    int blocks_y = (height + 3) / 4;
+    const unsigned char* ptr = blocks;
+
+    etc_block block;
+    for (int by = 0; by < blocks_y; by++) {
+        for (int bx = 0; bx < blocks_x; bx++) {
+            if (alpha) {
+                decode_alpha_block(get64(ptr), block.a);
+                ptr += 8;
+            } else {
+                std::fill(block.a, block.a + 16, 255);
+            }
+            decode_color_block(get64(ptr), block.r, block.g, block.b);
+            ptr += 8;
+
+            for (int i = 0; i < 16; i++) {
+                int x = bx * 4 + i / 4;
+                int y = by * 4 + i % 4;
+                if (x >= width || y >= height) continue;
+                unsigned char* p = rgba + (static_cast<size_t>(y) * width + x) * 4;
+                p[0] = static_cast<unsigned char>(block.r[i]);
+                p[1] = static_cast<unsigned char>(block.g[i]);
+                p[2] = static_cast<unsigned char>(block.b[i]);
+                p[3] = static_cast<unsigned char>(block.a[i]);
+            }
+        }
+    }
+}
+
+double etc2_psnr(const unsigned char* a, const unsigned char* b, int width, int height, bool alpha)
+{
+    int channels = alpha ? 4 : 3;
+    double sum = 0.0;
+    size_t pixels = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < pixels; i++) {
+        for (int c = 0; c < channels; c++) {
+            double d = static_cast<double>(a[i * 4 + c]) - b[i * 4 + c];
+            sum += d * d;
+        }
+    }
+
+    double mse = sum / (static_cast<double>(pixels) * channels);
+    if (mse <= 0.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+std::vector<unsigned char> ktx_write(uint32_t internal_format, int width, int height, const std::vector<unsigned char>& data)
+{
+    static const uint8_t identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+    ktx_header header = {};
+    std::memcpy(header.identifier, identifier, sizeof(identifier));
+    header.endianness = 0x04030201;
+    header.gl_type_size = 1;   // KTX 1.1 requires 1 for compressed formats
+    header.gl_internal_format = internal_format;
+    header.gl_base_internal_format = (internal_format == ETC2_RGBA8_EAC_FORMAT) ? 0x1908 : 0x1907;  // GL_RGBA / GL_RGB
+    header.pixel_width = width;
+    header.pixel_height = height;
+    header.number_of_faces = 1;
+    header.number_of_mipmap_levels = 1;
+
+    uint32_t image_size = data.size();
+
+    std::vector<unsigned char> out(sizeof(header) + sizeof(image_size) + data.size());
+    std::memcpy(out.data(), &header, sizeof(header));
+    std::memcpy(out.data() + sizeof(header), &image_size, sizeof(image_size));
+    std::memcpy(out.data() + sizeof(header) + sizeof(image_size), data.data(), data.size());
+    return out;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// ETC2 block compression for image resources. GLES 3.0 samples both formats natively.
+#define ETC2_RGB8_FORMAT        0x9274  // GL_COMPRESSED_RGB8_ETC2, 8 bytes per 4x4 block
+#define ETC2_RGBA8_EAC_FORMAT   0x9278  // GL_COMPRESSED_RGBA8_ETC2_EAC, 16 bytes per 4x4 block
+
+// encodes an RGBA8 image; alpha selects the EAC format, otherwise the alpha channel is ignored
+std::vector<unsigned char> etc2_encode(const unsigned char* rgba, int width, int height, bool alpha);
+
+// decodes blocks written by etc2_encode back to RGBA8 (used to check the encoder output)
+void etc2_decode(const unsigned char* blocks, int width, int height, bool alpha, unsigned char* rgba);
+
+// peak signal-to-noise ratio between two RGBA8 images in dB, over RGB (and A when alpha is set)
+double etc2_psnr(const unsigned char* a, const unsigned char* b, int width, int height, bool alpha);
+
+// wraps a single-level image in a KTX 1.1 container
+std::vector<unsigned char> ktx_write(uint32_t internal_format, int width, int height, const std::vector<unsigned char>& data);
@@ -40,3 +40,60 @@ struct resource_pack_file {
     resource_pack_header header;
     resource_entry* entries;
 };
+
+// atlas info
+// stored in the resource pack as "__atlas/atlas.bin", next to the pages "__atlas/page<N>.png":
+//   atlas_table_header
+//   page_count x { uint16_t width; uint16_t height; }
+//   entry_count x { uint16_t path_length; char path[path_length]; uint16_t page, x, y, width, height; }
+struct atlas_table_header {
+    char magic[4];
+    uint32_t page_count;
+    uint32_t entry_count;
+};
+
+// ktx 1.1 container, written for ETC2 compressed images. followed by bytes_of_key_value_data
+// bytes of metadata, then per mip level a uint32_t image size and the level data.
+struct ktx_header {
+    uint8_t identifier[12];
+    uint32_t endianness;
+    uint32_t gl_type;
+    uint32_t gl_type_size;
+    uint32_t gl_format;
+    uint32_t gl_internal_format;
+    uint32_t gl_base_internal_format;
+    uint32_t pixel_width;
+    uint32_t pixel_height;
+    uint32_t pixel_depth;
+    uint32_t number_of_array_elements;
+    uint32_t number_of_faces;
+    uint32_t number_of_mipmap_levels;
+    uint32_t bytes_of_key_value_data;
+};
+
+// cooked mesh (.gmesh), see mesh.cpp. little endian:
+//   gmesh_header
+//   attribute_count x gmesh_attribute
+//   vertex data, vertex_count * vertex_stride bytes, starting at a 4 byte aligned offset
+//   index data, index_count * index_size bytes, starting at a 4 byte aligned offset
+// snorm16 positions are relative to the bounds: position = center + value * half extent
+struct gmesh_header {
+    char magic[4];
+    uint16_t version;
+    uint16_t attribute_count;
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint16_t vertex_stride;
+    uint16_t index_size;
+    float bounds_min[3];
+    float bounds_max[3];
+};
+
+struct gmesh_attribute {
+    uint8_t location;       // 0 position, 1 normal, 2 texcoord
+    uint8_t components;
+    uint8_t normalized;
+    uint8_t reserved;
+    uint16_t type;          // GL component type
+    uint16_t offset;
+};
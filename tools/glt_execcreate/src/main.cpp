@@ -1,5 +1,6 @@
 #include <iostream>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
@@ -7,9 +8,16 @@
 #include <cjson/cJSON.h>
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
+#include <algorithm>
+#include <set>
+#include <string>
 #include <vector>
 
 #include "includes.h"
+#include "etc2.h"
+#include "mesh.h"
 
 const void *read_file(const char *path, size_t *out_size)
 {
@@ -24,7 +32,349 @@ const void *read_file(const char *path, size_t *out_size)
 
 
 
-resource_pack_file create_resource_pack(const char* resource_directory, size_t* out_size)
+// atlas options, from the "atlas" entry of the title config
+struct atlas_config {
+    bool enabled = false;
+    int page_size = 2048;       // GLES 3 guarantees at least 2048x2048 textures
+    int max_size = 1024;        // larger images stay standalone
+    int padding = 2;            // edge pixels are extruded into the padding to stop filtering bleed
+    bool keep_sources = false;  // also keep the packed images as separate resources
+    std::vector<std::string> exclude;
+};
+
+// texture compression options, from the "compress" entry of the title config
+struct compress_config {
+    bool enabled = false;
+    double min_psnr = 32.0;     // images that would come out worse stay uncompressed
+    std::vector<std::string> exclude;
+};
+
+struct atlas_image {
+    std::string path;   // relative to the resource directory
+    int width, height;
+    unsigned char* pixels;
+    int cell_width, cell_height;    // space taken on the page: the image, its padding and any block alignment
+    int page, x, y;
+};
+
+struct atlas_shelf {
+    int y, height, cursor_x;
+};
+
+struct atlas_page {
+    int width, height;
+    std::vector<atlas_shelf> shelves;   // top to bottom
+};
+
+static resource_entry make_resource_entry(const std::string& path, const void* data, uint32_t data_size)
+{
+    resource_entry entry;
+    entry.path_length = path.length();
+    entry.path = new char[entry.path_length + 1];
+    std::memcpy(entry.path, path.c_str(), entry.path_length);
+    entry.path[entry.path_length] = '\0';
+    entry.data_size = data_size;
+    entry.data = data;
+    return entry;
+}
+
+static bool is_image_resource(const std::string& rel)
+{
+    std::string ext = std::filesystem::path(rel).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".tga" || ext == ".bmp";
+}
+
+static bool is_mesh_resource(const std::string& rel)
+{
+    std::string ext = std::filesystem::path(rel).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".obj" || ext == ".gltf";
+}
+
+// loads an OBJ or glTF file and cooks it into a .gmesh; false when the source could not be read
+static bool cook_mesh(const std::string& name, const std::filesystem::path& path, const mesh_config& meshes,
+    std::vector<unsigned char>* out, std::vector<std::string>* dependencies)
+{
+    size_t size = 0;
+    const char* text = static_cast<const char*>(read_file(path.string().c_str(), &size));
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    mesh_source source;
+    bool loaded = (ext == ".gltf")
+        ? mesh_load_gltf(std::string(text, size).c_str(), path.parent_path().string(), &source, dependencies)
+        : mesh_load_obj(text, size, &source);
+    delete[] text;
+
+    if (!loaded) {
+        std::cerr << "Warning: failed to load mesh: " << name << "\n";
+        return false;
+    }
+
+    mesh_cook_stats stats;
+    *out = mesh_cook(source, meshes, &stats);
+
+    std::cout << "Mesh: " << name << " " << stats.triangles << " triangles, " << stats.source_vertices << " -> " << stats.vertices
+              << " vertices, ACMR " << stats.acmr_before << " -> " << stats.acmr_after << ", "
+              << stats.source_bytes / 1024 << " KB -> " << stats.cooked_bytes / 1024 << " KB\n";
+    return true;
+}
+
+// encodes an RGBA8 image as ETC2 in a KTX container; false when the result would lose too much quality
+static bool compress_image(const std::string& name, const unsigned char* rgba, int width, int height,
+    const compress_config& compress, std::vector<unsigned char>* out)
+{
+    size_t pixel_count = static_cast<size_t>(width) * height;
+    bool alpha = false;
+    for (size_t i = 0; i < pixel_count && !alpha; i++) {
+        alpha = rgba[i * 4 + 3] != 255;
+    }
+
+    std::vector<unsigned char> blocks = etc2_encode(rgba, width, height, alpha);
+
+    // decode the blocks again and compare, so a bad encode is caught here instead of on screen
+    std::vector<unsigned char> decoded(pixel_count * 4);
+    etc2_decode(blocks.data(), width, height, alpha, decoded.data());
+    double psnr = etc2_psnr(rgba, decoded.data(), width, height, alpha);
+
+    std::cout << "ETC2: " << name << " " << width << "x" << height << (alpha ? " rgba" : " rgb") << ", "
+              << (pixel_count * (alpha ? 4 : 3)) / 1024 << " KB -> " << blocks.size() / 1024 << " KB, PSNR " << psnr << " dB\n";
+
+    if (psnr < compress.min_psnr) {
+        std::cerr << "Warning: " << name << " is below the minimum PSNR of " << compress.min_psnr << " dB, kept uncompressed\n";
+        return false;
+    }
+
+    *out = ktx_write(alpha ? ETC2_RGBA8_EAC_FORMAT : ETC2_RGB8_FORMAT, width, height, blocks);
+    return true;
+}
+
+// padded size of an image, rounded up to whole blocks so a compressed block never holds texels of two images
+static int atlas_cell_size(int size, int padding, int block)
+{
+    return (size + padding * 2 + block - 1) / block * block;
+}
+
+// puts an image on the first shelf of the page with room for it, or on a new shelf below the others
+static bool place_on_atlas_page(atlas_page& page, atlas_image& image, const atlas_config& atlas)
+{
+    int w = image.cell_width;
+    int h = image.cell_height;
+
+    atlas_shelf* target = nullptr;
+    for (atlas_shelf& shelf : page.shelves) {
+        if (shelf.cursor_x + w <= atlas.page_size && h <= shelf.height) {
+            target = &shelf;
+            break;
+        }
+    }
+
+    if (!target) {
+        int top = page.shelves.empty() ? 0 : page.shelves.back().y + page.shelves.back().height;
+        if (w > atlas.page_size || top + h > atlas.page_size) {
+            return false;
+        }
+        page.shelves.push_back({top, h, 0});
+        target = &page.shelves.back();
+    }
+
+    image.x = target->cursor_x + atlas.padding;
+    image.y = target->y + atlas.padding;
+    target->cursor_x += w;
+    return true;
+}
+
+// shelf packer: images sorted by height are laid out in rows. every open shelf of every page is tried before a
+// new shelf is started, and a new page only when no page has room for another shelf
+static std::vector<atlas_page> pack_atlas_images(std::vector<atlas_image>& images, const atlas_config& atlas)
+{
+    std::sort(images.begin(), images.end(), [](const atlas_image& a, const atlas_image& b) {
+        return a.height != b.height ? a.height > b.height : a.width > b.width;
+    });
+
+    std::vector<atlas_page> pages;
+    for (atlas_image& image : images) {
+        bool placed = false;
+        for (size_t p = 0; p < pages.size() && !placed; p++) {
+            if (place_on_atlas_page(pages[p], image, atlas)) {
+                image.page = p;
+                placed = true;
+            }
+        }
+
+        if (!placed) {
+            // no page has room left; create_atlas has already dropped images too big for an empty one
+            atlas_page page = {atlas.page_size, atlas.page_size, {{0, image.cell_height, image.cell_width}}};
+            image.page = pages.size();
+            image.x = atlas.padding;
+            image.y = atlas.padding;
+            pages.push_back(page);
+        }
+    }
+
+    // trim every page to the rows it uses, rounded up to a power of two
+    for (atlas_page& page : pages) {
+        int used = page.shelves.back().y + page.shelves.back().height;
+        int height = 1;
+        while (height < used) height *= 2;
+        page.height = std::min(height, atlas.page_size);
+    }
+
+    return pages;
+}
+
+static void write_png_to_vector(void* context, void* data, int size)
+{
+    std::vector<unsigned char>* out = static_cast<std::vector<unsigned char>*>(context);
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    out->insert(out->end(), bytes, bytes + size);
+}
+
+// packs the images of the resource directory into atlas pages; returns the new entries and the packed paths
+static std::vector<resource_entry> create_atlas(const char* resource_directory,
+    const std::vector<std::filesystem::path>& resource_files, const atlas_config& atlas, const compress_config& compress,
+    std::set<std::string>& packed_paths)
+{
+    std::vector<atlas_image> images;
+    for (const auto& path : resource_files) {
+        std::string rel = std::filesystem::relative(path, resource_directory).string();
+        if (!is_image_resource(rel) || std::find(atlas.exclude.begin(), atlas.exclude.end(), rel) != atlas.exclude.end()) {
+            continue;
+        }
+
+        atlas_image image;
+        int channels;
+        image.path = rel;
+        image.pixels = stbi_load(path.string().c_str(), &image.width, &image.height, &channels, 4);
+        if (!image.pixels) {
+            std::cerr << "Warning: failed to load image for atlas: " << rel << "\n";
+            continue;
+        }
+        // ETC2 encodes 4x4 blocks, so compressed pages keep every image cell, and with it every shelf, on that grid
+        int block = compress.enabled ? 4 : 1;
+        image.cell_width = atlas_cell_size(image.width, atlas.padding, block);
+        image.cell_height = atlas_cell_size(image.height, atlas.padding, block);
+        if (image.width > atlas.max_size || image.height > atlas.max_size ||
+            image.cell_width > atlas.page_size || image.cell_height > atlas.page_size) {
+            stbi_image_free(image.pixels);
+            continue;
+        }
+        images.push_back(image);
+    }
+
+    std::vector<resource_entry> entries;
+    if (images.empty()) {
+        return entries;
+    }
+
+    std::vector<atlas_page> pages = pack_atlas_images(images, atlas);
+
+    // rasterize and encode the pages
+    for (size_t p = 0; p < pages.size(); p++) {
+        const atlas_page& page = pages[p];
+        std::vector<unsigned char> pixels(static_cast<size_t>(page.width) * page.height * 4, 0);
+
+        for (const atlas_image& image : images) {
+            if (image.page != static_cast<int>(p)) {
+                continue;
+            }
+
+            // copy with the border extruded into the padding and the rest of the cell
+            for (int y = -atlas.padding; y < image.cell_height - atlas.padding; y++) {
+                int sy = std::min(std::max(y, 0), image.height - 1);
+                for (int x = -atlas.padding; x < image.cell_width - atlas.padding; x++) {
+                    int sx = std::min(std::max(x, 0), image.width - 1);
+                    const unsigned char* src = image.pixels + (static_cast<size_t>(sy) * image.width + sx) * 4;
+                    unsigned char* dst = pixels.data() + (static_cast<size_t>(image.y + y) * page.width + image.x + x) * 4;
+                    std::memcpy(dst, src, 4);
+                }
+            }
+        }
+
+        // compressed pages keep the .png name, the runtime tells the formats apart by content
+        std::string page_path = "__atlas/page" + std::to_string(p) + ".png";
+        std::vector<unsigned char>* encoded = new std::vector<unsigned char>();
+        if (!compress.enabled || !compress_image(page_path, pixels.data(), page.width, page.height, compress, encoded)) {
+            stbi_write_png_to_func(write_png_to_vector, encoded, page.width, page.height, 4, pixels.data(), page.width * 4);
+        }
+
+        entries.push_back(make_resource_entry(page_path, encoded->data(), encoded->size()));
+        std::cout << "Atlas page " << p << ": " << page.width << "x" << page.height << "\n";
+    }
+
+    // rect table
+    std::vector<unsigned char>* table = new std::vector<unsigned char>();
+    auto put = [table](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        table->insert(table->end(), bytes, bytes + size);
+    };
+    auto put16 = [&put](int value) {
+        uint16_t v = static_cast<uint16_t>(value);
+        put(&v, sizeof(v));
+    };
+
+    atlas_table_header header;
+    std::memcpy(header.magic, "GLTA", 4);
+    header.page_count = pages.size();
+    header.entry_count = images.size();
+    put(&header, sizeof(header));
+
+    for (const atlas_page& page : pages) {
+        put16(page.width);
+        put16(page.height);
+    }
+
+    for (const atlas_image& image : images) {
+        put16(image.path.length());
+        put(image.path.c_str(), image.path.length());
+        put16(image.page);
+        put16(image.x);
+        put16(image.y);
+        put16(image.width);
+        put16(image.height);
+
+        packed_paths.insert(image.path);
+        stbi_image_free(image.pixels);
+        std::cout << "Atlas: " << image.path << " -> page " << image.page << " (" << image.x << ", " << image.y << ")\n";
+    }
+
+    entries.push_back(make_resource_entry("__atlas/atlas.bin", table->data(), table->size()));
+    return entries;
+}
+
+// cooks the meshes of the resource directory; returns the new entries and the source paths they replace
+static std::vector<resource_entry> cook_meshes(const char* resource_directory,
+    const std::vector<std::filesystem::path>& resource_files, const mesh_config& meshes, std::set<std::string>& cooked_paths)
+{
+    std::vector<resource_entry> entries;
+    for (const auto& path : resource_files) {
+        std::string rel = std::filesystem::relative(path, resource_directory).string();
+        if (!is_mesh_resource(rel) || std::find(meshes.exclude.begin(), meshes.exclude.end(), rel) != meshes.exclude.end()) {
+            continue;
+        }
+
+        std::vector<unsigned char>* cooked = new std::vector<unsigned char>();
+        std::vector<std::string> dependencies;
+        if (!cook_mesh(rel, path, meshes, cooked, &dependencies)) {
+            delete cooked;
+            continue;
+        }
+
+        // titles load "model.obj" as "model.gmesh"
+        std::string cooked_path = std::filesystem::path(rel).replace_extension(".gmesh").string();
+        entries.push_back(make_resource_entry(cooked_path, cooked->data(), cooked->size()));
+
+        cooked_paths.insert(rel);
+        for (const std::string& dependency : dependencies) {
+            cooked_paths.insert(std::filesystem::relative(dependency, resource_directory).string());
+        }
+    }
+    return entries;
+}
+
+resource_pack_file create_resource_pack(const char* resource_directory, size_t* out_size, const atlas_config& atlas,
+    const compress_config& compress, const mesh_config& meshes)
 {
     // get list of files in resource directory
     std::vector<std::filesystem::path> resource_files;
@@ -35,35 +385,163 @@ resource_pack_file create_resource_pack(const char* resource_directory, size_t*
         }
     }
 
-    resource_pack_file res_pack;
-    std::memcpy(res_pack.header.magic, "GLTR", 4);
-    res_pack.header.resource_count = resource_files.size();
-    res_pack.entries = new resource_entry[res_pack.header.resource_count];
+    std::set<std::string> packed_paths;
+    std::vector<resource_entry> atlas_entries;
+    if (atlas.enabled) {
+        atlas_entries = create_atlas(resource_directory, resource_files, atlas, compress, packed_paths);
+    }
 
-    size_t total_size = sizeof(res_pack.header) + (res_pack.header.resource_count * sizeof(resource_entry));
+    std::set<std::string> cooked_paths;
+    std::vector<resource_entry> mesh_entries;
+    if (meshes.enabled) {
+        mesh_entries = cook_meshes(resource_directory, resource_files, meshes, cooked_paths);
+    }
 
+    std::vector<resource_entry> entries;
     for (size_t i = 0; i < resource_files.size(); i++) {
         const auto& path = resource_files[i];
+        std::string rel = std::filesystem::relative(path, resource_directory).string();
 
-        resource_entry entry;
-        entry.path_length = std::filesystem::relative(path, resource_directory).string().length();
+        // packed images are only reachable through the atlas unless asked otherwise
+        if (!atlas.keep_sources && packed_paths.count(rel)) {
+            continue;
+        }
 
+        // mesh sources (and glTF buffers) are replaced by their .gmesh
+        if (cooked_paths.count(rel)) {
+            continue;
+        }
 
-        entry.path = new char[entry.path_length + 1];
-        std::string rel = std::filesystem::relative(path, resource_directory).string();
-        std::memcpy(entry.path, rel.c_str(), entry.path_length);
-        entry.path[entry.path_length] = '\0';
-        entry.data_size = std::filesystem::file_size(path);
-        entry.data = read_file(path.string().c_str(), nullptr);
-        res_pack.entries[i] = entry;
+        // compressed images keep their path, so titles load them exactly like the original file
+        if (compress.enabled && is_image_resource(rel) &&
+            std::find(compress.exclude.begin(), compress.exclude.end(), rel) == compress.exclude.end()) {
+            int width, height, channels;
+            unsigned char* pixels = stbi_load(path.string().c_str(), &width, &height, &channels, 4);
+            if (pixels) {
+                std::vector<unsigned char>* ktx = new std::vector<unsigned char>();
+                bool compressed = compress_image(rel, pixels, width, height, compress, ktx);
+                stbi_image_free(pixels);
+                if (compressed) {
+                    entries.push_back(make_resource_entry(rel, ktx->data(), ktx->size()));
+                    continue;
+                }
+                delete ktx;
+            }
+        }
 
-        total_size += entry.path_length + entry.data_size;
+        entries.push_back(make_resource_entry(rel, read_file(path.string().c_str(), nullptr), std::filesystem::file_size(path)));
+    }
+    entries.insert(entries.end(), atlas_entries.begin(), atlas_entries.end());
+    entries.insert(entries.end(), mesh_entries.begin(), mesh_entries.end());
+
+    resource_pack_file res_pack;
+    std::memcpy(res_pack.header.magic, "GLTR", 4);
+    res_pack.header.resource_count = entries.size();
+    res_pack.entries = new resource_entry[res_pack.header.resource_count];
+
+    size_t total_size = sizeof(res_pack.header) + (res_pack.header.resource_count * sizeof(resource_entry));
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        res_pack.entries[i] = entries[i];
+        total_size += entries[i].path_length + entries[i].data_size;
     }
 
     if (out_size) *out_size = total_size;
     return res_pack;
 }
 
+static atlas_config read_atlas_config(cJSON* title)
+{
+    atlas_config atlas;
+    cJSON* config = cJSON_GetObjectItem(title, "atlas");
+    if (!config) {
+        return atlas;
+    }
+
+    // "atlas": true, or an object with options
+    if (!cJSON_IsObject(config)) {
+        atlas.enabled = cJSON_IsTrue(config);
+        return atlas;
+    }
+
+    atlas.enabled = !cJSON_IsFalse(cJSON_GetObjectItem(config, "enabled"));
+
+    cJSON* item = cJSON_GetObjectItem(config, "page_size");
+    if (cJSON_IsNumber(item)) atlas.page_size = static_cast<int>(cJSON_GetNumberValue(item));
+    item = cJSON_GetObjectItem(config, "max_size");
+    if (cJSON_IsNumber(item)) atlas.max_size = static_cast<int>(cJSON_GetNumberValue(item));
+    item = cJSON_GetObjectItem(config, "padding");
+    if (cJSON_IsNumber(item)) atlas.padding = static_cast<int>(cJSON_GetNumberValue(item));
+    atlas.keep_sources = cJSON_IsTrue(cJSON_GetObjectItem(config, "keep_sources"));
+
+    cJSON* exclude = cJSON_GetObjectItem(config, "exclude");
+    for (int i = 0; i < cJSON_GetArraySize(exclude); i++) {
+        const char* path = cJSON_GetStringValue(cJSON_GetArrayItem(exclude, i));
+        if (path) atlas.exclude.push_back(path);
+    }
+
+    return atlas;
+}
+
+static compress_config read_compress_config(cJSON* title)
+{
+    compress_config compress;
+    cJSON* config = cJSON_GetObjectItem(title, "compress");
+    if (!config) {
+        return compress;
+    }
+
+    // "compress": true, or an object with options
+    if (!cJSON_IsObject(config)) {
+        compress.enabled = cJSON_IsTrue(config);
+        return compress;
+    }
+
+    compress.enabled = !cJSON_IsFalse(cJSON_GetObjectItem(config, "enabled"));
+
+    cJSON* item = cJSON_GetObjectItem(config, "min_psnr");
+    if (cJSON_IsNumber(item)) compress.min_psnr = cJSON_GetNumberValue(item);
+
+    cJSON* exclude = cJSON_GetObjectItem(config, "exclude");
+    for (int i = 0; i < cJSON_GetArraySize(exclude); i++) {
+        const char* path = cJSON_GetStringValue(cJSON_GetArrayItem(exclude, i));
+        if (path) compress.exclude.push_back(path);
+    }
+
+    return compress;
+}
+
+static mesh_config read_mesh_config(cJSON* title)
+{
+    mesh_config meshes;
+    cJSON* config = cJSON_GetObjectItem(title, "meshes");
+    if (!config) {
+        return meshes;
+    }
+
+    // "meshes": true, or an object with options
+    if (!cJSON_IsObject(config)) {
+        meshes.enabled = cJSON_IsTrue(config);
+        return meshes;
+    }
+
+    meshes.enabled = !cJSON_IsFalse(cJSON_GetObjectItem(config, "enabled"));
+
+    const char* positions = cJSON_GetStringValue(cJSON_GetObjectItem(config, "positions"));
+    if (positions) meshes.positions = positions;
+    if (cJSON_IsFalse(cJSON_GetObjectItem(config, "octahedral_normals"))) meshes.octahedral_normals = false;
+    if (cJSON_IsFalse(cJSON_GetObjectItem(config, "unorm16_uvs"))) meshes.unorm16_uvs = false;
+    if (cJSON_IsFalse(cJSON_GetObjectItem(config, "optimize"))) meshes.optimize = false;
+
+    cJSON* exclude = cJSON_GetObjectItem(config, "exclude");
+    for (int i = 0; i < cJSON_GetArraySize(exclude); i++) {
+        const char* path = cJSON_GetStringValue(cJSON_GetArrayItem(exclude, i));
+        if (path) meshes.exclude.push_back(path);
+    }
+
+    return meshes;
+}
+
 void* serialize_resource_pack(const resource_pack_file& rpack, size_t size)
 {
     char* buffer = new char[size];
@@ -102,9 +580,43 @@ int main(int argc, char const *argv[])
 
     // exec_create: create a new executable file from a given binary and resource directory
     // usage: exec_create <input_binary> <title_config>
+    //        exec_create --etc2 <image> [min_psnr]   (encode one image and check its round-trip PSNR)
+    //        exec_create --mesh <obj|gltf> [output]   (cook one mesh and print its statistics)
+
+    if (argc >= 3 && std::strcmp(argv[1], "--etc2") == 0) {
+        compress_config compress;
+        if (argc >= 4) compress.min_psnr = std::atof(argv[3]);
+
+        int width, height, channels;
+        unsigned char* pixels = stbi_load(argv[2], &width, &height, &channels, 4);
+        if (!pixels) {
+            std::cerr << "Failed to load image: " << argv[2] << "\n";
+            return -1;
+        }
+
+        std::vector<unsigned char> ktx;
+        bool passed = compress_image(argv[2], pixels, width, height, compress, &ktx);
+        stbi_image_free(pixels);
+        return passed ? 0 : 1;
+    }
+
+    if (argc >= 3 && std::strcmp(argv[1], "--mesh") == 0) {
+        mesh_config meshes;
+        std::vector<unsigned char> cooked;
+        if (!cook_mesh(argv[2], argv[2], meshes, &cooked, nullptr)) {
+            return -1;
+        }
+        if (argc >= 4) {
+            std::ofstream output(argv[3], std::ios::binary);
+            output.write(reinterpret_cast<const char*>(cooked.data()), cooked.size());
+        }
+        return 0;
+    }
 
     if (argc != 3) {
         std::cerr << "Usage: " << argv[0] << " <input_binary> <title_config>\n";
+        std::cerr << "       " << argv[0] << " --etc2 <image> [min_psnr]\n";
+        std::cerr << "       " << argv[0] << " --mesh <obj|gltf> [output]\n";
         return -1;
     }
 
@@ -178,7 +690,7 @@ int main(int argc, char const *argv[])
 
         // load resources
         size_t res_size = 0;
-        resource_pack_file rpack = create_resource_pack(resource_path.c_str(), &res_size);
+        resource_pack_file rpack = create_resource_pack(resource_path.c_str(), &res_size, read_atlas_config(title), read_compress_config(title), read_mesh_config(title));
 
 
 
@@ -0,0 +1,668 @@
+#include "mesh.h"
+
+#include <cjson/cJSON.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+#include "includes.h"
+
+#define GMESH_VERSION 1
+
+#define GL_BYTE_TYPE            0x1400
+#define GL_SHORT_TYPE           0x1402
+#define GL_UNSIGNED_SHORT_TYPE  0x1403
+#define GL_FLOAT_TYPE           0x1406
+#define GL_HALF_FLOAT_TYPE      0x140B
+
+// post-transform cache the optimizer aims for; ACMR is measured with a smaller FIFO, like most tile GPUs have
+#define MESH_CACHE_SIZE 32
+#define MESH_FIFO_SIZE 16
+
+// ---- OBJ ----
+
+static int obj_index(int index, size_t count)
+{
+    // 1-based, negative counts back from the end
+    return index > 0 ? index - 1 : static_cast<int>(count) + index;
+}
+
+bool mesh_load_obj(const char* text, size_t size, mesh_source* out)
+{
+    std::vector<float> positions, normals, uvs;
+    std::istringstream stream(std::string(text, size));
+    std::string line;
+
+    bool missing_normals = false;
+    bool missing_uvs = false;
+
+    while (std::getline(stream, line)) {
+        std::istringstream tokens(line);
+        std::string type;
+        tokens >> type;
+
+        if (type == "v") {
+            float x = 0, y = 0, z = 0;
+            tokens >> x >> y >> z;
+            positions.insert(positions.end(), {x, y, z});
+        } else if (type == "vn") {
+            float x = 0, y = 0, z = 0;
+            tokens >> x >> y >> z;
+            normals.insert(normals.end(), {x, y, z});
+        } else if (type == "vt") {
+            float u = 0, v = 0;
+            tokens >> u >> v;
+            uvs.insert(uvs.end(), {u, 1.0f - v});   // OBJ puts v = 0 at the bottom, textures are uploaded top row first
+        } else if (type == "f") {
+            std::vector<mesh_vertex> corners;
+            std::string corner;
+            while (tokens >> corner) {
+                int v = 0, t = 0, n = 0;
+                const char* ptr = corner.c_str();
+                v = std::atoi(ptr);
+                const char* slash = std::strchr(ptr, '/');
+                if (slash) {
+                    t = std::atoi(slash + 1);
+                    const char* slash2 = std::strchr(slash + 1, '/');
+                    if (slash2) n = std::atoi(slash2 + 1);
+                }
+
+                int vi = obj_index(v, positions.size() / 3);
+                if (vi < 0 || static_cast<size_t>(vi) * 3 >= positions.size()) {
+                    std::cerr << "OBJ: face references missing vertex " << v << "\n";
+                    return false;
+                }
+
+                mesh_vertex vertex = {};
+                std::memcpy(vertex.position, &positions[vi * 3], sizeof(vertex.position));
+
+                int ti = t ? obj_index(t, uvs.size() / 2) : -1;
+                if (ti >= 0 && static_cast<size_t>(ti) * 2 < uvs.size()) {
+                    std::memcpy(vertex.uv, &uvs[ti * 2], sizeof(vertex.uv));
+                } else {
+                    missing_uvs = true;
+                }
+
+                int ni = n ? obj_index(n, normals.size() / 3) : -1;
+                if (ni >= 0 && static_cast<size_t>(ni) * 3 < normals.size()) {
+                    std::memcpy(vertex.normal, &normals[ni * 3], sizeof(vertex.normal));
+                } else {
+                    missing_normals = true;
+                }
+
+                corners.push_back(vertex);
+            }
+
+            // polygons are fanned from their first corner
+            for (size_t i = 2; i < corners.size(); i++) {
+                uint32_t base = static_cast<uint32_t>(out->vertices.size());
+                out->vertices.push_back(corners[0]);
+                out->vertices.push_back(corners[i - 1]);
+                out->vertices.push_back(corners[i]);
+                out->indices.insert(out->indices.end(), {base, base + 1, base + 2});
+            }
+        }
+    }
+
+    out->has_normals = !missing_normals;
+    out->has_uvs = !missing_uvs && !uvs.empty();
+    return !out->indices.empty();
+}
+
+// ---- glTF ----
+
+static std::vector<unsigned char> base64_decode(const char* text)
+{
+    std::vector<unsigned char> result;
+    uint32_t accumulator = 0;
+    int bits = 0;
+    for (const char* c = text; *c && *c != '='; c++) {
+        int value;
+        if (*c >= 'A' && *c <= 'Z') value = *c - 'A';
+        else if (*c >= 'a' && *c <= 'z') value = *c - 'a' + 26;
+        else if (*c >= '0' && *c <= '9') value = *c - '0' + 52;
+        else if (*c == '+') value = 62;
+        else if (*c == '/') value = 63;
+        else continue;
+
+        accumulator = (accumulator << 6) | value;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            result.push_back(static_cast<unsigned char>(accumulator >> bits));
+        }
+    }
+    return result;
+}
+
+static int gltf_int(cJSON* object, const char* name, int fallback)
+{
+    cJSON* item = cJSON_GetObjectItem(object, name);
+    return cJSON_IsNumber(item) ? static_cast<int>(cJSON_GetNumberValue(item)) : fallback;
+}
+
+// returns a pointer to the first element and the stride between elements, or nullptr
+static const unsigned char* gltf_accessor(cJSON* root, const std::vector<unsigned char>& buffer, int index,
+    int* count, int* component_type, int* components, size_t* stride)
+{
+    cJSON* accessor = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "accessors"), index);
+    if (!accessor) return nullptr;
+
+    cJSON* view = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "bufferViews"), gltf_int(accessor, "bufferView", -1));
+    if (!view || gltf_int(view, "buffer", 0) != 0) return nullptr;
+
+    const char* type = cJSON_GetStringValue(cJSON_GetObjectItem(accessor, "type"));
+    *components = !type ? 0 : std::strcmp(type, "SCALAR") == 0 ? 1 : std::strcmp(type, "VEC2") == 0 ? 2 :
+                  std::strcmp(type, "VEC3") == 0 ? 3 : std::strcmp(type, "VEC4") == 0 ? 4 : 0;
+    *count = gltf_int(accessor, "count", 0);
+    *component_type = gltf_int(accessor, "componentType", 0);
+
+    size_t component_size = (*component_type == 5121) ? 1 : (*component_type == 5123) ? 2 : 4;
+    size_t offset = static_cast<size_t>(gltf_int(view, "byteOffset", 0)) + gltf_int(accessor, "byteOffset", 0);
+    *stride = gltf_int(view, "byteStride", 0);
+    if (*stride == 0) *stride = component_size * *components;
+
+    if (*components == 0 || *count <= 0 || offset + (*count - 1) * *stride + component_size * *components > buffer.size()) {
+        return nullptr;
+    }
+    return buffer.data() + offset;
+}
+
+bool mesh_load_gltf(const char* json, const std::string& directory, mesh_source* out, std::vector<std::string>* dependencies)
+{
+    cJSON* root = cJSON_Parse(json);
+    if (!root) {
+        std::cerr << "glTF: invalid JSON\n";
+        return false;
+    }
+
+    std::vector<unsigned char> buffer;
+    const char* uri = cJSON_GetStringValue(cJSON_GetObjectItem(cJSON_GetArrayItem(cJSON_GetObjectItem(root, "buffers"), 0), "uri"));
+    if (uri && std::strncmp(uri, "data:", 5) == 0) {
+        const char* comma = std::strchr(uri, ',');
+        if (comma) buffer = base64_decode(comma + 1);
+    } else if (uri) {
+        std::filesystem::path path = std::filesystem::path(directory) / uri;
+        std::ifstream file(path, std::ios::binary);
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (dependencies) dependencies->push_back(path.string());
+    }
+
+    cJSON* mesh = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "meshes"), 0);
+    cJSON* primitives = cJSON_GetObjectItem(mesh, "primitives");
+
+    out->has_normals = true;
+    out->has_uvs = true;
+
+    for (int p = 0; p < cJSON_GetArraySize(primitives); p++) {
+        cJSON* primitive = cJSON_GetArrayItem(primitives, p);
+        if (gltf_int(primitive, "mode", 4) != 4) {
+            std::cerr << "glTF: skipping non-triangle primitive " << p << "\n";
+            continue;
+        }
+
+        cJSON* attributes = cJSON_GetObjectItem(primitive, "attributes");
+        int count, type, components;
+        size_t stride;
+
+        const unsigned char* positions = gltf_accessor(root, buffer, gltf_int(attributes, "POSITION", -1), &count, &type, &components, &stride);
+        if (!positions || type != 5126 || components != 3) {
+            std::cerr << "glTF: primitive " << p << " has no float VEC3 positions\n";
+            continue;
+        }
+
+        uint32_t base = static_cast<uint32_t>(out->vertices.size());
+        int vertex_count = count;
+        out->vertices.resize(base + vertex_count);
+        for (int i = 0; i < vertex_count; i++) {
+            std::memcpy(out->vertices[base + i].position, positions + i * stride, sizeof(float) * 3);
+        }
+
+        int normal_count, uv_count;
+        size_t normal_stride, uv_stride;
+        const unsigned char* normals = gltf_accessor(root, buffer, gltf_int(attributes, "NORMAL", -1), &normal_count, &type, &components, &normal_stride);
+        if (normals && type == 5126 && components == 3 && normal_count == vertex_count) {
+            for (int i = 0; i < vertex_count; i++) {
+                std::memcpy(out->vertices[base + i].normal, normals + i * normal_stride, sizeof(float) * 3);
+            }
+        } else {
+            out->has_normals = false;
+        }
+
+        const unsigned char* uvs = gltf_accessor(root, buffer, gltf_int(attributes, "TEXCOORD_0", -1), &uv_count, &type, &components, &uv_stride);
+        if (uvs && type == 5126 && components == 2 && uv_count == vertex_count) {
+            for (int i = 0; i < vertex_count; i++) {
+                std::memcpy(out->vertices[base + i].uv, uvs + i * uv_stride, sizeof(float) * 2);
+            }
+        } else {
+            out->has_uvs = false;
+        }
+
+        const unsigned char* indices = gltf_accessor(root, buffer, gltf_int(primitive, "indices", -1), &count, &type, &components, &stride);
+        if (indices) {
+            for (int i = 0; i < count; i++) {
+                uint32_t index = 0;
+                if (type == 5121) index = indices[i * stride];
+                else if (type == 5123) { uint16_t value; std::memcpy(&value, indices + i * stride, 2); index = value; }
+                else std::memcpy(&index, indices + i * stride, 4);
+                out->indices.push_back(base + std::min<uint32_t>(index, vertex_count - 1));
+            }
+        } else {
+            for (int i = 0; i < vertex_count; i++) {
+                out->indices.push_back(base + i);
+            }
+        }
+    }
+
+    cJSON_Delete(root);
+    out->indices.resize(out->indices.size() - out->indices.size() % 3);
+    return !out->indices.empty();
+}
+
+// ---- vertex cache ----
+
+static double mesh_acmr(const std::vector<uint32_t>& indices)
+{
+    std::vector<uint32_t> fifo;
+    size_t misses = 0;
+    for (uint32_t index : indices) {
+        if (std::find(fifo.begin(), fifo.end(), index) == fifo.end()) {
+            misses++;
+            fifo.push_back(index);
+            if (fifo.size() > MESH_FIFO_SIZE) fifo.erase(fifo.begin());
+        }
+    }
+    return indices.empty() ? 0.0 : static_cast<double>(misses) / (indices.size() / 3);
+}
+
+// Tom Forsyth's "Linear-Speed Vertex Cache Optimisation": greedily emits the triangle whose vertices
+// score best, where recently used vertices and vertices with few remaining triangles score high
+static float forsyth_score(int cache_position, int remaining)
+{
+    if (remaining == 0) return -1.0f;
+
+    float score = 0.0f;
+    if (cache_position >= 0) {
+        if (cache_position < 3) {
+            score = 0.75f;      // the last triangle's vertices, slightly penalised so strips don't loop back
+        } else {
+            float scaled = 1.0f - static_cast<float>(cache_position - 3) / (MESH_CACHE_SIZE - 3);
+            score = std::pow(scaled, 1.5f);
+        }
+    }
+    return score + 2.0f * std::pow(static_cast<float>(remaining), -0.5f);
+}
+
+static std::vector<uint32_t> mesh_optimize_cache(const std::vector<uint32_t>& indices, size_t vertex_count)
+{
+    size_t triangle_count = indices.size() / 3;
+
+    std::vector<int> remaining(vertex_count, 0);
+    for (uint32_t index : indices) remaining[index]++;
+
+    // triangles per vertex, as offsets into one array
+    std::vector<size_t> first(vertex_count + 1, 0);
+    for (size_t v = 0; v < vertex_count; v++) first[v + 1] = first[v] + remaining[v];
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<size_t> fill(first.begin(), first.end() - 1);
+    for (size_t t = 0; t < triangle_count; t++) {
+        for (int k = 0; k < 3; k++) adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+    }
+
+    std::vector<int> cache_position(vertex_count, -1);
+    std::vector<float> vertex_score(vertex_count);
+    for (size_t v = 0; v < vertex_count; v++) vertex_score[v] = forsyth_score(-1, remaining[v]);
+
+    std::vector<float> triangle_score(triangle_count);
+    std::vector<bool> emitted(triangle_count, false);
+    for (size_t t = 0; t < triangle_count; t++) {
+        triangle_score[t] = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    std::vector<uint32_t> cache;
+    size_t scan = 0;    // triangles before this are all emitted
+
+    int best = -1;
+    while (result.size() < indices.size()) {
+        if (best < 0) {
+            // nothing in the cache is connected to anything left: take the best unemitted triangle
+            while (scan < triangle_count && emitted[scan]) scan++;
+            float best_score = -1.0f;
+            for (size_t t = scan; t < triangle_count; t++) {
+                if (!emitted[t] && triangle_score[t] > best_score) {
+                    best_score = triangle_score[t];
+                    best = static_cast<int>(t);
+                }
+            }
+        }
+
+        emitted[best] = true;
+        std::vector<uint32_t> next_cache;
+        for (int k = 0; k < 3; k++) {
+            uint32_t v = indices[best * 3 + k];
+            result.push_back(v);
+            remaining[v]--;
+            next_cache.push_back(v);
+
+            // drop the triangle from the vertex's list so its score only counts live triangles
+            auto begin = adjacency.begin() + first[v];
+            auto end = begin + remaining[v] + 1;
+            auto it = std::find(begin, end, static_cast<uint32_t>(best));
+            std::iter_swap(it, end - 1);
+        }
+        for (uint32_t v : cache) {
+            if (std::find(next_cache.begin(), next_cache.end(), v) == next_cache.end()) next_cache.push_back(v);
+        }
+
+        // vertices pushed out of the cache lose their cache bonus too
+        for (size_t i = 0; i < next_cache.size(); i++) {
+            cache_position[next_cache[i]] = (i < MESH_CACHE_SIZE) ? static_cast<int>(i) : -1;
+        }
+
+        best = -1;
+        float best_score = -1.0f;
+        for (uint32_t v : next_cache) {
+            float score = forsyth_score(cache_position[v], remaining[v]);
+            float delta = score - vertex_score[v];
+            vertex_score[v] = score;
+            for (int i = 0; i < remaining[v]; i++) {
+                uint32_t t = adjacency[first[v] + i];
+                triangle_score[t] += delta;
+                if (triangle_score[t] > best_score) {
+                    best_score = triangle_score[t];
+                    best = static_cast<int>(t);
+                }
+            }
+        }
+
+        if (next_cache.size() > MESH_CACHE_SIZE) next_cache.resize(MESH_CACHE_SIZE);
+        cache.swap(next_cache);
+    }
+
+    return result;
+}
+
+// ---- quantization ----
+
+static uint16_t float_to_half(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int exponent = static_cast<int>((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (exponent <= 0) {
+        if (exponent < -10) return static_cast<uint16_t>(sign);
+        mantissa |= 0x800000;
+        uint32_t shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1) half++;     // round to nearest
+        return static_cast<uint16_t>(sign | half);
+    }
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7c00);   // overflow becomes infinity
+    }
+
+    uint32_t half = sign | (exponent << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000) half++;                      // round to nearest, may carry into the exponent
+    return static_cast<uint16_t>(half);
+}
+
+static int16_t to_snorm16(float value)
+{
+    value = std::max(-1.0f, std::min(1.0f, value));
+    return static_cast<int16_t>(std::lround(value * 32767.0f));
+}
+
+static uint16_t to_unorm16(float value)
+{
+    value = std::max(0.0f, std::min(1.0f, value));
+    return static_cast<uint16_t>(std::lround(value * 65535.0f));
+}
+
+// octahedral mapping: the unit sphere is folded onto a square, two numbers per normal
+static void octahedral_encode(const float* normal, float* out)
+{
+    float length = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+    if (length == 0.0f) {
+        out[0] = 0.0f;
+        out[1] = 0.0f;
+        return;
+    }
+
+    float x = normal[0] / length;
+    float y = normal[1] / length;
+    if (normal[2] < 0.0f) {
+        float folded_x = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float folded_y = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = folded_x;
+        y = folded_y;
+    }
+    out[0] = x;
+    out[1] = y;
+}
+
+static void mesh_generate_normals(std::vector<mesh_vertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    // smooth normals: face normals summed per position, so corners with equal positions agree
+    struct position_key {
+        float x, y, z;
+        bool operator==(const position_key& o) const { return x == o.x && y == o.y && z == o.z; }
+    };
+    struct position_hash {
+        size_t operator()(const position_key& k) const {
+            uint32_t h[3];
+            std::memcpy(h, &k, sizeof(h));
+            return h[0] * 73856093u ^ h[1] * 19349663u ^ h[2] * 83492791u;
+        }
+    };
+
+    std::unordered_map<position_key, std::array<float, 3>, position_hash> sums;
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        const float* a = vertices[indices[t]].position;
+        const float* b = vertices[indices[t + 1]].position;
+        const float* c = vertices[indices[t + 2]].position;
+        float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+        for (int k = 0; k < 3; k++) {
+            const float* p = vertices[indices[t + k]].position;
+            auto& sum = sums[{p[0], p[1], p[2]}];
+            sum[0] += n[0];
+            sum[1] += n[1];
+            sum[2] += n[2];
+        }
+    }
+
+    for (mesh_vertex& vertex : vertices) {
+        auto& sum = sums[{vertex.position[0], vertex.position[1], vertex.position[2]}];
+        float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+        for (int k = 0; k < 3; k++) {
+            vertex.normal[k] = length > 0.0f ? sum[k] / length : (k == 2 ? 1.0f : 0.0f);
+        }
+    }
+}
+
+static void push_bytes(std::vector<unsigned char>& out, const void* data, size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+static void pad_to_4(std::vector<unsigned char>& out)
+{
+    while (out.size() % 4) out.push_back(0);
+}
+
+std::vector<unsigned char> mesh_cook(const mesh_source& source, const mesh_config& config, mesh_cook_stats* stats)
+{
+    std::vector<mesh_vertex> vertices = source.vertices;
+    if (!source.has_normals) {
+        mesh_generate_normals(vertices, source.indices);
+    }
+
+    float bounds_min[3] = {0, 0, 0};
+    float bounds_max[3] = {0, 0, 0};
+    for (size_t i = 0; i < vertices.size(); i++) {
+        for (int k = 0; k < 3; k++) {
+            float p = vertices[i].position[k];
+            bounds_min[k] = (i == 0) ? p : std::min(bounds_min[k], p);
+            bounds_max[k] = (i == 0) ? p : std::max(bounds_max[k], p);
+        }
+    }
+
+    bool uvs_in_range = true;
+    for (const mesh_vertex& vertex : vertices) {
+        uvs_in_range = uvs_in_range && vertex.uv[0] >= 0.0f && vertex.uv[0] <= 1.0f && vertex.uv[1] >= 0.0f && vertex.uv[1] <= 1.0f;
+    }
+
+    // vertex layout; every attribute starts on a 4 byte boundary
+    std::vector<gmesh_attribute> attributes;
+    uint16_t stride = 0;
+    auto add_attribute = [&](uint8_t location, uint8_t components, uint16_t type, bool normalized, uint16_t size) {
+        gmesh_attribute attribute = {location, components, static_cast<uint8_t>(normalized), 0, type, stride};
+        attributes.push_back(attribute);
+        stride += (size + 3) & ~3;
+    };
+
+    if (config.positions == "snorm16") add_attribute(0, 3, GL_SHORT_TYPE, true, 6);
+    else if (config.positions == "half") add_attribute(0, 3, GL_HALF_FLOAT_TYPE, false, 6);
+    else add_attribute(0, 3, GL_FLOAT_TYPE, false, 12);
+
+    if (config.octahedral_normals) add_attribute(1, 2, GL_SHORT_TYPE, true, 4);
+    else add_attribute(1, 3, GL_FLOAT_TYPE, false, 12);
+
+    bool unorm_uvs = config.unorm16_uvs && uvs_in_range;
+    if (source.has_uvs) {
+        if (unorm_uvs) add_attribute(2, 2, GL_UNSIGNED_SHORT_TYPE, true, 4);
+        else add_attribute(2, 2, GL_FLOAT_TYPE, false, 8);
+    }
+
+    // quantize every corner, then weld corners whose quantized bytes match
+    float center[3], extent[3];
+    for (int k = 0; k < 3; k++) {
+        center[k] = (bounds_min[k] + bounds_max[k]) * 0.5f;
+        extent[k] = (bounds_max[k] - bounds_min[k]) * 0.5f;
+        if (extent[k] <= 0.0f) extent[k] = 1.0f;
+    }
+
+    std::vector<unsigned char> packed;
+    std::unordered_map<std::string, uint32_t> welded;
+    std::vector<uint32_t> indices;
+    indices.reserve(source.indices.size());
+
+    for (uint32_t source_index : source.indices) {
+        const mesh_vertex& vertex = vertices[source_index];
+        std::string bytes(stride, '\0');
+        unsigned char* ptr = reinterpret_cast<unsigned char*>(&bytes[0]);
+
+        const gmesh_attribute& position = attributes[0];
+        for (int k = 0; k < 3; k++) {
+            if (position.type == GL_SHORT_TYPE) {
+                int16_t value = to_snorm16((vertex.position[k] - center[k]) / extent[k]);
+                std::memcpy(ptr + position.offset + k * 2, &value, 2);
+            } else if (position.type == GL_HALF_FLOAT_TYPE) {
+                uint16_t value = float_to_half(vertex.position[k]);
+                std::memcpy(ptr + position.offset + k * 2, &value, 2);
+            } else {
+                std::memcpy(ptr + position.offset + k * 4, &vertex.position[k], 4);
+            }
+        }
+
+        const gmesh_attribute& normal = attributes[1];
+        if (normal.components == 2) {
+            float octahedral[2];
+            octahedral_encode(vertex.normal, octahedral);
+            int16_t value[2] = {to_snorm16(octahedral[0]), to_snorm16(octahedral[1])};
+            std::memcpy(ptr + normal.offset, value, sizeof(value));
+        } else {
+            std::memcpy(ptr + normal.offset, vertex.normal, sizeof(vertex.normal));
+        }
+
+        if (attributes.size() > 2) {
+            const gmesh_attribute& uv = attributes[2];
+            if (uv.type == GL_UNSIGNED_SHORT_TYPE) {
+                uint16_t value[2] = {to_unorm16(vertex.uv[0]), to_unorm16(vertex.uv[1])};
+                std::memcpy(ptr + uv.offset, value, sizeof(value));
+            } else {
+                std::memcpy(ptr + uv.offset, vertex.uv, sizeof(vertex.uv));
+            }
+        }
+
+        auto it = welded.find(bytes);
+        if (it == welded.end()) {
+            it = welded.emplace(bytes, static_cast<uint32_t>(packed.size() / stride)).first;
+            packed.insert(packed.end(), bytes.begin(), bytes.end());
+        }
+        indices.push_back(it->second);
+    }
+
+    size_t vertex_count = packed.size() / stride;
+    double acmr_before = mesh_acmr(indices);
+
+    if (config.optimize) {
+        indices = mesh_optimize_cache(indices, vertex_count);
+
+        // renumber vertices in first-use order, so vertex fetches walk the buffer forwards
+        std::vector<uint32_t> remap(vertex_count, UINT32_MAX);
+        std::vector<unsigned char> ordered(packed.size());
+        uint32_t next = 0;
+        for (uint32_t& index : indices) {
+            if (remap[index] == UINT32_MAX) {
+                std::memcpy(&ordered[next * stride], &packed[index * stride], stride);
+                remap[index] = next++;
+            }
+            index = remap[index];
+        }
+        packed.swap(ordered);
+    }
+
+    uint16_t index_size = vertex_count <= 0xffff ? 2 : 4;
+
+    gmesh_header header;
+    std::memcpy(header.magic, "GMSH", 4);
+    header.version = GMESH_VERSION;
+    header.attribute_count = static_cast<uint16_t>(attributes.size());
+    header.vertex_count = static_cast<uint32_t>(vertex_count);
+    header.index_count = static_cast<uint32_t>(indices.size());
+    header.vertex_stride = stride;
+    header.index_size = index_size;
+    std::memcpy(header.bounds_min, bounds_min, sizeof(bounds_min));
+    std::memcpy(header.bounds_max, bounds_max, sizeof(bounds_max));
+
+    std::vector<unsigned char> out;
+    push_bytes(out, &header, sizeof(header));
+    push_bytes(out, attributes.data(), attributes.size() * sizeof(gmesh_attribute));
+    pad_to_4(out);
+    push_bytes(out, packed.data(), packed.size());
+    pad_to_4(out);
+    for (uint32_t index : indices) {
+        if (index_size == 2) {
+            uint16_t value = static_cast<uint16_t>(index);
+            push_bytes(out, &value, 2);
+        } else {
+            push_bytes(out, &index, 4);
+        }
+    }
+
+    if (stats) {
+        stats->source_vertices = source.vertices.size();
+        stats->vertices = vertex_count;
+        stats->triangles = indices.size() / 3;
+        stats->acmr_before = acmr_before;
+        stats->acmr_after = mesh_acmr(indices);
+        stats->source_bytes = vertex_count * (source.has_uvs ? 32 : 24) + indices.size() * 4;
+        stats->cooked_bytes = out.size();
+    }
+    return out;
+}
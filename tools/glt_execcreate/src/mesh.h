@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// mesh cooking: OBJ and glTF source meshes are turned into .gmesh files the runtime uploads as is
+
+struct mesh_vertex {
+    float position[3];
+    float normal[3];
+    float uv[2];
+};
+
+// triangle list; vertices may be duplicated, the cooker welds them
+struct mesh_source {
+    std::vector<mesh_vertex> vertices;
+    std::vector<uint32_t> indices;
+    bool has_normals = false;
+    bool has_uvs = false;
+};
+
+// mesh options, from the "meshes" entry of the title config
+struct mesh_config {
+    bool enabled = false;
+    std::string positions = "snorm16";  // "snorm16" (relative to the bounds), "half" or "float"
+    bool octahedral_normals = true;     // two snorm16 instead of three floats
+    bool unorm16_uvs = true;            // falls back to floats when a UV is outside 0..1
+    bool optimize = true;               // vertex cache ordering
+    std::vector<std::string> exclude;
+};
+
+struct mesh_cook_stats {
+    size_t source_vertices = 0;
+    size_t vertices = 0;
+    size_t triangles = 0;
+    double acmr_before = 0;     // average cache miss ratio (vertex shader runs per triangle), 16 entry FIFO
+    double acmr_after = 0;
+    size_t source_bytes = 0;    // the same vertices as float position/normal/uv with 32 bit indices
+    size_t cooked_bytes = 0;
+};
+
+bool mesh_load_obj(const char* text, size_t size, mesh_source* out);
+
+// glTF 2.0 subset: the first mesh, triangle primitives, float attributes, one buffer (file or data: uri)
+bool mesh_load_gltf(const char* json, const std::string& directory, mesh_source* out, std::vector<std::string>* dependencies);
+
+std::vector<unsigned char> mesh_cook(const mesh_source& source, const mesh_config& config, mesh_cook_stats* stats);